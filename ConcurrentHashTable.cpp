@@ -0,0 +1,302 @@
+/**
+ * ConcurrentHashTable.cpp
+ */
+
+#include "ConcurrentHashTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <thread>
+
+/**
+* ConcurrentHashTable constructor: Creates the shards. The shard count is rounded up to a power of two
+*   so a shard can be picked straight from the high bits of a key's hash. Every shard gets a copy of the
+*   table's one randomly seeded hasher.
+*
+* param :
+*   shardCount: number of shards, 0 picks four per hardware thread
+*   initShardCapacity: starting capacity of each shard's HashTable
+*/
+ConcurrentHashTable::ConcurrentHashTable(size_t shardCount, size_t initShardCapacity) {
+    if (shardCount == 0) {
+        shardCount = std::max<size_t>(std::thread::hardware_concurrency(), 1) * 4;
+    }
+    shardCount = std::bit_ceil(shardCount);
+
+    this->shardShift = 64 - std::countr_zero(shardCount);
+    this->shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; i++) {
+        this->shards.push_back(std::make_unique<Shard>(initShardCapacity, this->hasher));
+    }
+}
+
+/**
+* insert: Insert a key-value pair into the key's shard, only that shard is locked
+*
+* param :
+*   key: the key to input into the table
+*   value: the value associated with the key
+*
+* returns:
+*   bool: true if the key was inserted, false if it was already in the table
+*/
+bool ConcurrentHashTable::insert(std::string_view key, size_t value) {
+    size_t hashValue = this->hash(key);
+    return this->withShard(this->shardOf(hashValue), [&](HashTable& table) {
+        return table.insertHashed(key, hashValue, value);
+    });
+}
+
+/**
+* insert_or_assign: Insert a key-value pair, or set the value of the key if it is already in the table
+*
+* param :
+*   key: the key to input into the table
+*   value: the value the key should have
+*
+* returns:
+*   bool: true if the key was inserted, false if an existing value was replaced
+*/
+bool ConcurrentHashTable::insert_or_assign(std::string_view key, size_t value) {
+    size_t hashValue = this->hash(key);
+    return this->withShard(this->shardOf(hashValue), [&](HashTable& table) {
+        return table.insertOrAssignHashed(key, hashValue, value);
+    });
+}
+
+/**
+* remove: Remove a key from its shard
+*
+* param :
+*   key: the key to remove
+*
+* returns:
+*   bool: true if the key was removed, false if it was not in the table
+*/
+bool ConcurrentHashTable::remove(std::string_view key) {
+    size_t hashValue = this->hash(key);
+    return this->withShard(this->shardOf(hashValue), [&](HashTable& table) {
+        return table.removeHashed(key, hashValue);
+    });
+}
+
+/**
+* contains: Check if key is in table
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   bool: true if it is in container false if it is not
+*/
+bool ConcurrentHashTable::contains(std::string_view key) const {
+    size_t hashValue = this->hash(key);
+    return this->withShard(this->shardOf(hashValue), [&](const HashTable& table) {
+        return table.containsHashed(key, hashValue);
+    });
+}
+
+/**
+* get: Check if key is in table and return the value
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   std::optional<size_t>: Value of key if it is in the table or nullopt if key is not in table
+*/
+std::optional<size_t> ConcurrentHashTable::get(std::string_view key) const {
+    size_t hashValue = this->hash(key);
+    return this->withShard(this->shardOf(hashValue), [&](const HashTable& table) {
+        return table.getHashed(key, hashValue);
+    });
+}
+
+/**
+* insertBulk: Insert many key-value pairs. The pairs are grouped by shard first so each shard is locked
+*   once for all of its keys instead of once per key.
+*
+* param :
+*   pairs: the key-value pairs to insert
+*
+* returns:
+*   size_t: number of keys that were inserted, keys already in the table are skipped
+*/
+size_t ConcurrentHashTable::insertBulk(const std::vector<std::pair<std::string, size_t>>& pairs) {
+    std::vector<std::vector<size_t>> byShard(this->shards.size());
+    std::vector<size_t> hashes(pairs.size());
+    for (size_t i = 0; i < pairs.size(); i++) {
+        hashes[i] = this->hash(pairs[i].first);
+        byShard[this->shardOf(hashes[i])].push_back(i);
+    }
+
+    size_t inserted = 0;
+    for (size_t shard = 0; shard < byShard.size(); shard++) {
+        if (byShard[shard].empty()) {
+            continue;
+        }
+        inserted += this->withShard(shard, [&](HashTable& table) {
+            size_t shardInserted = 0;
+            table.reserve(table.size() + byShard[shard].size());
+            for (size_t index : byShard[shard]) {
+                shardInserted += table.insertHashed(pairs[index].first, hashes[index], pairs[index].second);
+            }
+            return shardInserted;
+        });
+    }
+    return inserted;
+}
+
+/**
+* removeBulk: Remove many keys, locking each shard once for all of its keys
+*
+* param :
+*   keys: the keys to remove
+*
+* returns:
+*   size_t: number of keys that were removed
+*/
+size_t ConcurrentHashTable::removeBulk(const std::vector<std::string>& keys) {
+    std::vector<std::vector<size_t>> byShard(this->shards.size());
+    std::vector<size_t> hashes(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        hashes[i] = this->hash(keys[i]);
+        byShard[this->shardOf(hashes[i])].push_back(i);
+    }
+
+    size_t removed = 0;
+    for (size_t shard = 0; shard < byShard.size(); shard++) {
+        if (byShard[shard].empty()) {
+            continue;
+        }
+        removed += this->withShard(shard, [&](HashTable& table) {
+            size_t shardRemoved = 0;
+            for (size_t index : byShard[shard]) {
+                shardRemoved += table.removeHashed(keys[index], hashes[index]);
+            }
+            return shardRemoved;
+        });
+    }
+    return removed;
+}
+
+/**
+* keys: Get list of all keys in the table, gathered one shard at a time
+*
+* returns:
+*   std::vector<std::string>: List of all keys
+*/
+std::vector<std::string> ConcurrentHashTable::keys() const {
+    std::vector<std::string> curKeyList;
+    this->forEach([&](std::string_view key, size_t) {
+        curKeyList.emplace_back(key);
+    });
+    return curKeyList;
+}
+
+/**
+* size: Returns number of keys in all shards. Shards are counted one after another, so with writers
+*   running the total is only a close estimate.
+*
+* returns:
+*   size_t: Number of keys
+*/
+size_t ConcurrentHashTable::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < this->shards.size(); i++) {
+        total += this->withShard(i, [](const HashTable& table) { return table.size(); });
+    }
+    return total;
+}
+
+/**
+* capacity: Get the total number of buckets in all shards
+*
+* returns:
+*   size_t: Number of total buckets
+*/
+size_t ConcurrentHashTable::capacity() const {
+    size_t total = 0;
+    for (size_t i = 0; i < this->shards.size(); i++) {
+        total += this->withShard(i, [](const HashTable& table) { return table.capacity(); });
+    }
+    return total;
+}
+
+/**
+* alpha: get the load factor over all shards
+*
+* returns:
+*   double: size/capacity
+*/
+double ConcurrentHashTable::alpha() const {
+    return static_cast<double>(this->size()) / static_cast<double>(this->capacity());
+}
+
+/**
+* shardCount: Get the number of shards
+*
+* returns:
+*   size_t: Number of shards, a power of two
+*/
+size_t ConcurrentHashTable::shardCount() const {
+    return this->shards.size();
+}
+
+/**
+* shardFor: Get the shard a key lives in
+*
+* param :
+*   key: the key to route
+*
+* returns:
+*   size_t: Index of the key's shard
+*/
+size_t ConcurrentHashTable::shardFor(std::string_view key) const {
+    return this->shardOf(this->hash(key));
+}
+
+/**
+* hash: Hash a key the way every shard's HashTable does. The shards all share this table's hasher, so
+*   this one value both routes the key and finds it inside its shard.
+*
+* param :
+*   key: the key to hash
+*
+* returns:
+*   size_t: the hashed value of the key
+*/
+size_t ConcurrentHashTable::hash(std::string_view key) const {
+    return this->hasher(key);
+}
+
+/**
+* shardOf: Get the shard for a hashed key. The high bits of the hash pick the shard so the low bits the
+*   shard's HashTable uses for the home bucket stay spread out.
+*
+* param :
+*   hashValue: the hashed value of the key, see hash()
+*
+* returns:
+*   size_t: Index of the key's shard
+*/
+size_t ConcurrentHashTable::shardOf(size_t hashValue) const {
+    if (this->shards.size() == 1) {
+        return 0;
+    }
+    return hashValue >> this->shardShift;
+}
+
+/**
+* reserve: Make room for a number of keys spread evenly over the shards
+*
+* param :
+*   count: the number of keys the table should hold without growing
+*/
+void ConcurrentHashTable::reserve(size_t count) {
+    size_t perShard = count / this->shards.size() + 1;
+    for (size_t i = 0; i < this->shards.size(); i++) {
+        this->withShard(i, [&](HashTable& table) { table.reserve(perShard); });
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "HashTable.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+/**
+ * ConcurrentHashTable.h
+ *
+ * Thread safe hash table made of independently locked HashTable shards. A key always lives in the
+ * shard picked by the high bits of its hash, so writers to different shards never wait on each other
+ * and each shard resizes on its own without stalling the rest of the table. Lookups only take their
+ * shard's lock shared, so readers of one shard run side by side and only wait for its writers.
+ */
+class ConcurrentHashTable {
+    private:
+        //Shards sit on their own cache lines so locking one does not bounce its neighbours
+        struct alignas(64) Shard {
+            mutable std::shared_mutex lock;
+            HashTable table;
+
+            Shard(size_t initCapacity, const WyHash& hasher) : table(initCapacity, hasher) {}
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        size_t shardShift;
+        //Every shard's HashTable is built with a copy of this hasher, so one hash routes a key and finds it
+        WyHash hasher;
+
+        size_t shardOf(size_t hashValue) const;
+
+    public:
+        explicit ConcurrentHashTable(size_t shardCount = 0, size_t initShardCapacity = HashTable::DEFAULT_INITIAL_CAPACITY);
+        bool insert(std::string_view key, size_t value);
+        bool insert_or_assign(std::string_view key, size_t value);
+        bool remove(std::string_view key);
+        bool contains(std::string_view key) const;
+        std::optional<size_t> get(std::string_view key) const;
+        size_t insertBulk(const std::vector<std::pair<std::string, size_t>>& pairs);
+        size_t removeBulk(const std::vector<std::string>& keys);
+        std::vector<std::string> keys() const;
+        size_t size() const;
+        size_t capacity() const;
+        double alpha() const;
+        size_t shardCount() const;
+        size_t shardFor(std::string_view key) const;
+        size_t hash(std::string_view key) const;
+        void reserve(size_t count);
+
+    /**
+     * withShard: run a function on one shard's HashTable while holding that shard's lock, for
+     *      read-modify-write sequences that have to be atomic. The function must not touch other shards.
+     *      The const overload only takes the lock shared, so other readers of the shard keep running.
+     *
+     *      paramaters:
+     *          shard: index of the shard, see shardFor()
+     *          function: called with a reference to the shard's HashTable
+     *
+     *      returns:
+     *          whatever the function returns
+    */
+    template <typename Function>
+    decltype(auto) withShard(size_t shard, Function&& function) {
+        std::unique_lock<std::shared_mutex> guard(this->shards[shard]->lock);
+        return std::forward<Function>(function)(this->shards[shard]->table);
+    }
+
+    template <typename Function>
+    decltype(auto) withShard(size_t shard, Function&& function) const {
+        std::shared_lock<std::shared_mutex> guard(this->shards[shard]->lock);
+        return std::forward<Function>(function)(std::as_const(this->shards[shard]->table));
+    }
+
+    /**
+     * forEach: call a function for every key-value pair, one shard at a time. Each shard is locked
+     *      while it is visited, so the walk is not a snapshot of the whole table.
+     *
+     *      paramaters:
+     *          function: called with (std::string_view key, size_t value)
+    */
+    template <typename Function>
+    void forEach(Function&& function) const {
+        for (size_t i = 0; i < this->shards.size(); i++) {
+            this->withShard(i, [&](const HashTable& table) {
+                for (const auto& [key, value] : table) {
+                    function(key, value);
+                }
+            });
+        }
+    }
+};
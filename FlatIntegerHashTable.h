@@ -0,0 +1,717 @@
+#pragma once
+
+#include "HashTable.h"
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+/**
+ * FlatIntegerHashTable.h
+ *
+ * FlatIntegerHashTable: BasicHashTable specialization for uint32_t and uint64_t keys. Keys and values are
+ * kept in two flat arrays and the two largest key values mark empty and removed slots, so a slot is
+ * just sizeof(Key) + sizeof(Value) bytes with no BucketType. Probing is linear over groups of
+ * GROUP_SIZE keys, which are compared against the key being looked for with SSE2 when it is available.
+ * The two reserved key values can still be inserted, they are kept outside the arrays.
+ *
+ * The layout is opt in: it is picked by the FlatKeyEqual comparison, which the FlatIntegerHashTable
+ * alias passes. A BasicHashTable<uint64_t, Value> with the default std::equal_to stays the general
+ * table with every mode.
+ *
+ * Differences from the general table: the capacity is always a power of two (the growth factor is
+ * rounded up to one) and resizes always rehash in one go, there is no incremental resize. There is
+ * no Robin Hood, cuckoo, Bloom filter or cache mode, no save/load, no *Hashed entry points and no
+ * get_allocator. Tables that need those use the general table.
+ */
+
+//Keys that can use the flat layout
+template <typename Key>
+concept FlatIntegerKey = std::unsigned_integral<Key> and (sizeof(Key) == 4 or sizeof(Key) == 8);
+
+//Compares keys like std::equal_to<Key>, passing it as the KeyEqual opts a table into the flat layout
+template <typename Key>
+struct FlatKeyEqual : std::equal_to<Key> {};
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+    requires FlatIntegerKey<Key> and std::is_same_v<KeyEqual, FlatKeyEqual<Key>>
+class BasicHashTable<Key, Value, Hash, KeyEqual, Allocator> {
+    public:
+        using KeyView = Key;
+        using KeyValue = Key;
+
+    private:
+        static constexpr Key EMPTY_KEY = std::numeric_limits<Key>::max();
+        static constexpr Key REMOVED_KEY = EMPTY_KEY - 1;
+        static constexpr size_t SENTINEL_COUNT = 2;
+
+        using KeyAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Key>;
+        using ValueAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Value>;
+
+        std::vector<Key, KeyAllocator> keyData;
+        std::vector<Value, ValueAllocator> valueData;
+        //Slots for the reserved keys, kept out of the arrays. Position capacity() + i in iteration
+        std::array<Value, SENTINEL_COUNT> sentinelValues{};
+        std::array<bool, SENTINEL_COUNT> hasSentinel{};
+        size_t numSize;
+        size_t numRemoved;
+        double maxLoadFactor;
+        double growthFactor;
+        mutable HashTableStats counters;
+        [[no_unique_address]] Hash hasher;
+
+        /**
+        * sentinelSlot: get which side slot a reserved key lives in
+        *
+        * returns:
+        *   size_t: 0 for EMPTY_KEY, 1 for REMOVED_KEY, SENTINEL_COUNT for any other key
+        */
+        static size_t sentinelSlot(Key key) {
+            return key == EMPTY_KEY ? 0 : key == REMOVED_KEY ? 1 : SENTINEL_COUNT;
+        }
+
+        /**
+        * mix: spread a hash over all 64 bits (splitmix64 finalizer) so the low bits used for the home slot
+        *   are good even when the hash is the identity, as std::hash of an integer usually is
+        */
+        static size_t mix(size_t hashValue) {
+            uint64_t mixed = hashValue;
+            mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(mixed ^ (mixed >> 31));
+        }
+
+        /**
+        * matchGroup: compare GROUP_SIZE keys against one key
+        *
+        * param :
+        *   group: the first of GROUP_SIZE keys
+        *   key: the key to compare them with
+        *
+        * returns:
+        *   uint32_t: bit i is set if group[i] == key
+        */
+        static uint32_t matchGroup(const Key* group, Key key) {
+#ifdef __SSE2__
+            if constexpr (sizeof(Key) == 4) {
+                __m128i needle = _mm_set1_epi32(static_cast<int>(key));
+                __m128i low = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)), needle);
+                __m128i high = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group + 4)), needle);
+                return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(low)) |
+                                             (_mm_movemask_ps(_mm_castsi128_ps(high)) << 4));
+            }
+            else {
+                __m128i needle = _mm_set1_epi64x(static_cast<long long>(key));
+                uint32_t matches = 0;
+                for (size_t i = 0; i < GROUP_SIZE; i += 2) {
+                    __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group + i)), needle);
+                    //SSE2 has no 64 bit compare, a key matches when both of its 32 bit halves do
+                    equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+                    matches |= static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(equal))) << i;
+                }
+                return matches;
+            }
+#else
+            uint32_t matches = 0;
+            for (size_t i = 0; i < GROUP_SIZE; i++) {
+                matches |= static_cast<uint32_t>(group[i] == key) << i;
+            }
+            return matches;
+#endif
+        }
+
+        /**
+        * scan: walk the slots from a hash's home slot one group at a time until wanted() picks a slot
+        *   or an empty slot ends the probe
+        *
+        * param :
+        *   keys: the key array to walk
+        *   hashValue: hash of the key being probed for
+        *   wanted: called with a group and the offset of the first slot to consider, gives back a
+        *       bit mask of the slots it would take
+        *   stopAtEmpty: if true an empty slot before any wanted slot ends the walk
+        *   probes: set to the number of slots looked at
+        *
+        * returns:
+        *   std::optional<size_t>: the first wanted slot, or nullopt if an empty slot came first
+        */
+        template <typename Wanted>
+        static std::optional<size_t> scan(const std::vector<Key, KeyAllocator>& keys, size_t hashValue, Wanted&& wanted,
+                                          bool stopAtEmpty, size_t& probes) {
+            size_t mask = keys.size() - 1;
+            size_t home = mix(hashValue) & mask;
+            size_t index = home;
+            for (size_t scanned = 0; scanned < keys.size() + GROUP_SIZE;) {
+                size_t groupStart = index & ~(GROUP_SIZE - 1);
+                size_t offset = index - groupStart;
+                const Key* group = keys.data() + groupStart;
+                uint32_t hits = wanted(group) >> offset;
+                if (stopAtEmpty) {
+                    uint32_t empties = matchGroup(group, EMPTY_KEY) >> offset;
+                    if (empties != 0) {
+                        //Only slots before the first empty one are part of the probe sequence
+                        hits &= (empties & (~empties + 1)) - 1;
+                        if (hits == 0) {
+                            probes = ((index + std::countr_zero(empties) - home) & mask) + 1;
+                            return std::nullopt;
+                        }
+                    }
+                }
+                if (hits != 0) {
+                    size_t found = index + std::countr_zero(hits);
+                    probes = ((found - home) & mask) + 1;
+                    return found;
+                }
+                scanned += GROUP_SIZE - offset;
+                index = (groupStart + GROUP_SIZE) & mask;
+            }
+            probes = keys.size();
+            return std::nullopt;
+        }
+
+        /**
+        * findIndex: find the slot holding a key that is not one of the reserved keys
+        *
+        * returns:
+        *   std::optional<size_t>: Index of the key's slot or nullopt if it is not in the table
+        */
+        std::optional<size_t> findIndex(Key key, size_t hashValue) const {
+            size_t probes = 0;
+            std::optional<size_t> index = scan(this->keyData, hashValue,
+                                               [key](const Key* group) { return matchGroup(group, key); }, true, probes);
+            if constexpr (HASHTABLE_STATS_ENABLED) {
+                HashTableStats::recordProbeLength(index ? this->counters.hitProbeLengths : this->counters.missProbeLengths, probes);
+                HashTableStats::recordMax(this->counters.maxProbeLength, probes);
+            }
+            return index;
+        }
+
+        /**
+        * findValue: find the value of any key, reserved ones included
+        *
+        * returns:
+        *   const Value*: Pointer to the key's value or nullptr if the key is not in the table
+        */
+        const Value* findValue(Key key, size_t hashValue) const {
+            if (size_t slot = sentinelSlot(key); slot != SENTINEL_COUNT) {
+                return this->hasSentinel[slot] ? &this->sentinelValues[slot] : nullptr;
+            }
+            std::optional<size_t> index = this->findIndex(key, hashValue);
+            return index ? &this->valueData[*index] : nullptr;
+        }
+
+        /**
+        * placeKey: put a key that is not in a key array into the first empty or removed slot of its probe
+        *
+        * returns:
+        *   size_t: Index of the slot the key went into
+        */
+        static size_t placeKey(std::vector<Key, KeyAllocator>& keys, Key key, size_t hashValue, size_t& probes) {
+            size_t index = *scan(keys, hashValue, [](const Key* group) {
+                return matchGroup(group, EMPTY_KEY) | matchGroup(group, REMOVED_KEY);
+            }, false, probes);
+            keys[index] = key;
+            return index;
+        }
+
+        /**
+        * arrayCount: get the number of keys in the arrays, which is every key but the reserved ones
+        */
+        size_t arrayCount() const {
+            return this->numSize - this->hasSentinel[0] - this->hasSentinel[1];
+        }
+
+        /**
+        * capacityFor: get the smallest power of two capacity that holds a number of keys without going
+        *   over the max load factor
+        */
+        size_t capacityFor(size_t count) const {
+            size_t newCapacity = GROUP_SIZE;
+            while (static_cast<double>(count) > this->maxLoadFactor * static_cast<double>(newCapacity)) {
+                newCapacity *= 2;
+            }
+            return newCapacity;
+        }
+
+        /**
+        * rehash: move every key into new arrays of the given capacity, dropping removed slots
+        *
+        * param :
+        *   newCapacity: number of slots, a power of two of at least GROUP_SIZE
+        */
+        void rehash(size_t newCapacity) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Key, KeyAllocator> newKeys(newCapacity, EMPTY_KEY, this->keyData.get_allocator());
+            std::vector<Value, ValueAllocator> newValues(newCapacity, this->valueData.get_allocator());
+            size_t probes = 0;
+            for (size_t i = 0; i < this->keyData.size(); i++) {
+                Key key = this->keyData[i];
+                if (key != EMPTY_KEY and key != REMOVED_KEY) {
+                    newValues[placeKey(newKeys, key, this->hasher(key), probes)] = std::move(this->valueData[i]);
+                }
+            }
+
+            if constexpr (HASHTABLE_STATS_ENABLED) {
+                if (newCapacity == this->keyData.size()) {
+                    this->counters.inPlaceRehashCount++;
+                }
+                else {
+                    this->counters.resizeCount++;
+                }
+            }
+            this->keyData = std::move(newKeys);
+            this->valueData = std::move(newValues);
+            this->numRemoved = 0;
+            if constexpr (HASHTABLE_STATS_ENABLED) {
+                this->counters.resizeTime += std::chrono::steady_clock::now() - start;
+            }
+        }
+
+        /**
+        * tryEmplaceHashed: try_emplace for a key whose hash is already known. The arrays are grown (or
+        *   rehashed at the same size if removed slots are the problem) before a new key would push
+        *   them over the max load factor.
+        */
+        std::pair<Value&, bool> tryEmplaceHashed(Key key, size_t hashValue, Value value) {
+            if (size_t slot = sentinelSlot(key); slot != SENTINEL_COUNT) {
+                bool inserted = !this->hasSentinel[slot];
+                if (inserted) {
+                    this->hasSentinel[slot] = true;
+                    this->sentinelValues[slot] = std::move(value);
+                    this->numSize++;
+                }
+                return {this->sentinelValues[slot], inserted};
+            }
+            if (std::optional<size_t> index = this->findIndex(key, hashValue)) {
+                return {this->valueData[*index], false};
+            }
+
+            double limit = this->maxLoadFactor * static_cast<double>(this->capacity());
+            if (static_cast<double>(this->arrayCount() + this->numRemoved + 1) > limit) {
+                size_t newCapacity = this->capacity();
+                if (static_cast<double>(this->arrayCount() + 1) > limit) {
+                    size_t grown = std::bit_ceil(static_cast<size_t>(std::ceil(static_cast<double>(newCapacity) * this->growthFactor)));
+                    newCapacity = std::max(grown, this->capacityFor(this->arrayCount() + 1));
+                }
+                this->rehash(newCapacity);
+            }
+
+            size_t probes = 0;
+            size_t index = placeKey(this->keyData, key, hashValue, probes);
+            this->valueData[index] = std::move(value);
+            this->numSize++;
+            if constexpr (HASHTABLE_STATS_ENABLED) {
+                HashTableStats::recordProbeLength(this->counters.insertProbeLengths, probes);
+                HashTableStats::recordMax(this->counters.maxProbeLength, probes);
+            }
+            return {this->valueData[index], true};
+        }
+
+        /**
+        * batchProbe: hash a window of BATCH_WINDOW keys and prefetch their home slots before resolving
+        *   any of them, same as the general table's batch calls
+        */
+        template <typename KeyAt, typename Resolve>
+        void batchProbe(size_t count, KeyAt&& keyAt, Resolve&& resolve) const {
+            std::array<size_t, BATCH_WINDOW> hashes;
+            size_t mask = this->capacity() - 1;
+            for (size_t start = 0; start < count; start += BATCH_WINDOW) {
+                size_t windowSize = std::min(BATCH_WINDOW, count - start);
+                for (size_t i = 0; i < windowSize; i++) {
+                    hashes[i] = this->hash(keyAt(start + i));
+                    size_t home = mix(hashes[i]) & mask;
+                    prefetchAddress(&this->keyData[home]);
+                    prefetchAddress(&this->valueData[home]);
+                }
+                for (size_t i = 0; i < windowSize; i++) {
+                    resolve(start + i, hashes[i]);
+                }
+            }
+        }
+
+    public:
+        /**
+        * Iterator: forward iterator over the filled slots, then the reserved keys. Dereferencing gives a
+        *   (key, value) pair with the value by reference. Inserting or removing keys invalidates iterators.
+        */
+        template <bool IsConst>
+        class Iterator {
+            private:
+                using Table = std::conditional_t<IsConst, const BasicHashTable, BasicHashTable>;
+
+                Table* table;
+                size_t position;
+
+                void skipEmpty() {
+                    size_t capacity = this->table->capacity();
+                    while (this->position < capacity + SENTINEL_COUNT) {
+                        if (this->position < capacity) {
+                            Key key = this->table->keyData[this->position];
+                            if (key != EMPTY_KEY and key != REMOVED_KEY) {
+                                return;
+                            }
+                        }
+                        else if (this->table->hasSentinel[this->position - capacity]) {
+                            return;
+                        }
+                        this->position++;
+                    }
+                }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = std::pair<Key, Value>;
+                using reference = std::pair<Key, std::conditional_t<IsConst, const Value&, Value&>>;
+
+                struct pointer {
+                    reference ref;
+                    reference* operator->() { return &this->ref; }
+                };
+
+                Iterator() : table(nullptr), position(0) {}
+
+                Iterator(Table* table, size_t position) : table(table), position(position) {
+                    this->skipEmpty();
+                }
+
+                //A non-const iterator can always be used where a const one is expected
+                operator Iterator<true>() const {
+                    return Iterator<true>(this->table, this->position);
+                }
+
+                reference operator*() const {
+                    size_t capacity = this->table->capacity();
+                    if (this->position < capacity) {
+                        return {this->table->keyData[this->position], this->table->valueData[this->position]};
+                    }
+                    size_t slot = this->position - capacity;
+                    return {slot == 0 ? EMPTY_KEY : REMOVED_KEY, this->table->sentinelValues[slot]};
+                }
+
+                pointer operator->() const {
+                    return {**this};
+                }
+
+                Iterator& operator++() {
+                    this->position++;
+                    this->skipEmpty();
+                    return *this;
+                }
+
+                Iterator operator++(int) {
+                    Iterator previous = *this;
+                    ++*this;
+                    return previous;
+                }
+
+                bool operator==(const Iterator& other) const {
+                    return this->position == other.position;
+                }
+
+                //Position of the slot, capacity() and up are the reserved keys
+                size_t bucketIndex() const {
+                    return this->position;
+                }
+
+                //There is never an old table, this is here so operator<< works on every BasicHashTable
+                bool inOldTable() const {
+                    return false;
+                }
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        static constexpr size_t GROUP_SIZE = 8;
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+        static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.5;
+        static constexpr double DEFAULT_GROWTH_FACTOR = 2.0;
+        static constexpr size_t BATCH_WINDOW = 16;
+
+        /**
+        * BasicHashTable constructor: Makes empty arrays of at least initCapacity slots, rounded up to a
+        *   power of two. keyEquals is only there to match the general table, keys are compared with ==.
+        */
+        explicit BasicHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY, const Hash& hashFunction = Hash(),
+                                const KeyEqual& keyEquals = KeyEqual(), const Allocator& allocator = Allocator())
+            : keyData(std::bit_ceil(std::max(initCapacity, GROUP_SIZE)), EMPTY_KEY, KeyAllocator(allocator)),
+              valueData(std::bit_ceil(std::max(initCapacity, GROUP_SIZE)), ValueAllocator(allocator)),
+              numSize(0), numRemoved(0), maxLoadFactor(DEFAULT_MAX_LOAD_FACTOR), growthFactor(DEFAULT_GROWTH_FACTOR),
+              hasher(hashFunction) {
+            (void)keyEquals;
+        }
+
+        /**
+        * BasicHashTable range constructor: Makes a table holding the given pairs, built with bulkLoad
+        */
+        template <PairRangeOf<Key, Value> Range>
+        explicit BasicHashTable(Range&& pairs, const Hash& hashFunction = Hash(), const KeyEqual& keyEquals = KeyEqual(),
+                                const Allocator& allocator = Allocator())
+            : BasicHashTable(DEFAULT_INITIAL_CAPACITY, hashFunction, keyEquals, allocator) {
+            this->bulkLoad(pairs);
+        }
+
+        /**
+        * BasicHashTable copy constructor: Copies the slots and settings. The counters are read through
+        *   HashTableStats::snapshot since const lookups on the other table may be updating them.
+        */
+        BasicHashTable(const BasicHashTable& other)
+            : keyData(other.keyData), valueData(other.valueData), sentinelValues(other.sentinelValues),
+              hasSentinel(other.hasSentinel), numSize(other.numSize), numRemoved(other.numRemoved),
+              maxLoadFactor(other.maxLoadFactor), growthFactor(other.growthFactor), counters(other.counters.snapshot()),
+              hasher(other.hasher) {}
+
+        BasicHashTable(BasicHashTable&& other) = default;
+
+        /**
+        * BasicHashTable copy assignment: Copies the slots and settings into this table's own arrays, which
+        *   keep their allocator
+        */
+        BasicHashTable& operator=(const BasicHashTable& other) {
+            if (this != &other) {
+                this->keyData = other.keyData;
+                this->valueData = other.valueData;
+                this->sentinelValues = other.sentinelValues;
+                this->hasSentinel = other.hasSentinel;
+                this->numSize = other.numSize;
+                this->numRemoved = other.numRemoved;
+                this->maxLoadFactor = other.maxLoadFactor;
+                this->growthFactor = other.growthFactor;
+                this->counters = other.counters.snapshot();
+                this->hasher = other.hasher;
+            }
+            return *this;
+        }
+
+        BasicHashTable& operator=(BasicHashTable&& other) = default;
+
+        bool insert(Key key, Value value) {
+            return this->try_emplace(key, std::move(value)).second;
+        }
+
+        std::pair<Value&, bool> try_emplace(Key key, Value value) {
+            return this->tryEmplaceHashed(key, this->hash(key), std::move(value));
+        }
+
+        bool insert_or_assign(Key key, Value value) {
+            auto [curValue, inserted] = this->try_emplace(key, value);
+            if (!inserted) {
+                curValue = std::move(value);
+            }
+            return inserted;
+        }
+
+        /**
+        * remove: Take a key out of the table. Its slot is marked removed, or empty if the next slot is
+        *   already empty since then no probe can be running through it.
+        *
+        * returns:
+        *   bool: true if the key was removed, false if it was not in the table
+        */
+        bool remove(Key key) {
+            if (size_t slot = sentinelSlot(key); slot != SENTINEL_COUNT) {
+                if (!this->hasSentinel[slot]) {
+                    return false;
+                }
+                this->hasSentinel[slot] = false;
+                this->sentinelValues[slot] = Value();
+                this->numSize--;
+                return true;
+            }
+
+            std::optional<size_t> index = this->findIndex(key, this->hash(key));
+            if (!index) {
+                return false;
+            }
+            size_t next = (*index + 1) & (this->capacity() - 1);
+            if (this->keyData[next] == EMPTY_KEY) {
+                this->keyData[*index] = EMPTY_KEY;
+            }
+            else {
+                this->keyData[*index] = REMOVED_KEY;
+                this->numRemoved++;
+            }
+            this->valueData[*index] = Value();
+            this->numSize--;
+            return true;
+        }
+
+        bool contains(Key key) const {
+            return this->findValue(key, this->hash(key)) != nullptr;
+        }
+
+        std::optional<Value> get(Key key) const {
+            if (const Value* value = this->findValue(key, this->hash(key))) {
+                return *value;
+            }
+            return std::nullopt;
+        }
+
+        size_t getBatch(std::span<const Key> keys, std::span<std::optional<Value>> results) const {
+            size_t found = 0;
+            this->batchProbe(std::min(keys.size(), results.size()),
+                             [&](size_t i) { return keys[i]; },
+                             [&](size_t i, size_t hashValue) {
+                                 const Value* value = this->findValue(keys[i], hashValue);
+                                 results[i] = value != nullptr ? std::optional<Value>(*value) : std::nullopt;
+                                 found += value != nullptr;
+                             });
+            return found;
+        }
+
+        size_t containsBatch(std::span<const Key> keys, std::span<bool> results) const {
+            size_t found = 0;
+            this->batchProbe(std::min(keys.size(), results.size()),
+                             [&](size_t i) { return keys[i]; },
+                             [&](size_t i, size_t hashValue) {
+                                 results[i] = this->findValue(keys[i], hashValue) != nullptr;
+                                 found += results[i];
+                             });
+            return found;
+        }
+
+        size_t insertBatch(std::span<const std::pair<Key, Value>> pairs) {
+            this->reserve(this->size() + pairs.size());
+            size_t inserted = 0;
+            this->batchProbe(pairs.size(),
+                             [&](size_t i) { return pairs[i].first; },
+                             [&](size_t i, size_t hashValue) {
+                                 inserted += this->tryEmplaceHashed(pairs[i].first, hashValue, pairs[i].second).second;
+                             });
+            return inserted;
+        }
+
+        /**
+        * bulkLoad: Insert a large batch of pairs after growing the arrays once for all of them. Probing
+        *   flat arrays is cheap enough that the keys are then just inserted in order on this thread.
+        *
+        * returns:
+        *   size_t: number of keys that were inserted, the first of two equal keys wins
+        */
+        template <PairRangeOf<Key, Value> Range>
+        size_t bulkLoad(Range&& pairs) {
+            this->reserve(this->size() + std::ranges::size(pairs));
+            size_t inserted = 0;
+            for (auto&& pair : pairs) {
+                Key key = pair.first;
+                inserted += this->tryEmplaceHashed(key, this->hash(key), Value(pair.second)).second;
+            }
+            return inserted;
+        }
+
+        size_t capacity() const {
+            return this->keyData.size();
+        }
+
+        Value& operator[](Key key) {
+            return this->try_emplace(key, Value()).first;
+        }
+
+        std::vector<Key> keys() const {
+            std::vector<Key> curKeyList;
+            curKeyList.reserve(this->size());
+            for (const auto& [key, value] : *this) {
+                curKeyList.push_back(key);
+            }
+            return curKeyList;
+        }
+
+        double alpha() const {
+            return static_cast<double>(this->size()) / static_cast<double>(this->capacity());
+        }
+
+        size_t size() const {
+            return this->numSize;
+        }
+
+        size_t removedCount() const {
+            return this->numRemoved;
+        }
+
+        HashTableStats stats() const {
+            HashTableStats snapshot = this->counters.snapshot();
+            snapshot.removedBuckets = this->numRemoved;
+            return snapshot;
+        }
+
+        void resetStats() {
+            this->counters = HashTableStats();
+        }
+
+        size_t hash(Key key) const {
+            return this->hasher(key);
+        }
+
+        std::optional<int> getIndex(Key key) const {
+            return this->findIndex(key, this->hash(key));
+        }
+
+        void reserve(size_t count) {
+            size_t newCapacity = this->capacityFor(count);
+            if (newCapacity > this->capacity()) {
+                this->rehash(newCapacity);
+            }
+        }
+
+        void shrink_to_fit() {
+            this->rehash(std::min(this->capacityFor(this->arrayCount()), this->capacity()));
+        }
+
+        bool setMaxLoadFactor(double loadFactor) {
+            if (!(loadFactor > 0.0 and loadFactor < 1.0)) {
+                return false;
+            }
+            this->maxLoadFactor = loadFactor;
+            this->reserve(this->arrayCount());
+            return true;
+        }
+
+        double getMaxLoadFactor() const {
+            return this->maxLoadFactor;
+        }
+
+        bool setGrowthFactor(double factor) {
+            if (!(factor > 1.0)) {
+                return false;
+            }
+            this->growthFactor = factor;
+            return true;
+        }
+
+        double getGrowthFactor() const {
+            return this->growthFactor;
+        }
+
+        iterator begin() {
+            return iterator(this, 0);
+        }
+
+        iterator end() {
+            return iterator(this, this->capacity() + SENTINEL_COUNT);
+        }
+
+        const_iterator begin() const {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator end() const {
+            return const_iterator(this, this->capacity() + SENTINEL_COUNT);
+        }
+
+        const_iterator cbegin() const {
+            return this->begin();
+        }
+
+        const_iterator cend() const {
+            return this->end();
+        }
+};
+
+//uint32_t or uint64_t keyed table with the flat layout
+template <FlatIntegerKey Key, typename Value, typename Hash = typename KeyStorage<Key>::DefaultHash,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>>
+using FlatIntegerHashTable = BasicHashTable<Key, Value, Hash, FlatKeyEqual<Key>, Allocator>;
@@ -0,0 +1,457 @@
+/**
+ * FrozenHashTable.cpp
+ */
+
+#include "FrozenHashTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+* mulHigh: get the high 64 bits of a 64x64 bit product. Written out by hand where there is no 128 bit
+*   type so every platform puts keys in the same slots.
+*/
+uint64_t mulHigh(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a), bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+    uint64_t highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+    uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+    return aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+}
+
+//splitmix64 finalizer
+uint64_t mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/**
+* groupFor: get the group a key's hash falls in, from the high bits of the hash
+*/
+uint64_t groupFor(uint64_t hashValue, uint64_t groupCount) {
+    return mulHigh(hashValue, groupCount);
+}
+
+/**
+* slotFor: get the slot a key goes to under its group's pilot. The hash and pilot are mixed again so
+*   keys whose hashes only differ in their low bits still land far apart.
+*/
+uint64_t slotFor(uint64_t hashValue, uint32_t pilot, uint64_t seed, uint64_t keyCount) {
+    return mulHigh(mix(hashValue ^ mix(pilot ^ seed)), keyCount);
+}
+
+/**
+* findPilots: search a pilot for every group so each key gets a slot of its own. The biggest groups
+*   go first while most slots are still free, each trying pilots 0, 1, 2... until all of its keys
+*   land on free slots that differ from each other.
+*
+* param :
+*   hashes: the hash of every key
+*   groupCount: the number of groups
+*   seed: the seed the hashes were made with
+*   pilots: set to the pilot of each group
+*   slotOf: set to the slot of each key
+*
+* returns:
+*   bool: false if two keys had the same hash or a group ran out of pilots, a new seed is needed then
+*/
+bool findPilots(const std::vector<uint64_t>& hashes, uint64_t groupCount, uint64_t seed, std::vector<uint32_t>& pilots,
+                std::vector<uint64_t>& slotOf) {
+    uint64_t keyCount = hashes.size();
+
+    //Counting sort the keys by group
+    std::vector<uint64_t> groupStart(groupCount + 1, 0);
+    for (uint64_t hashValue : hashes) {
+        groupStart[groupFor(hashValue, groupCount) + 1]++;
+    }
+    for (uint64_t g = 0; g < groupCount; g++) {
+        groupStart[g + 1] += groupStart[g];
+    }
+    std::vector<uint64_t> members(keyCount);
+    std::vector<uint64_t> fill(groupStart.begin(), groupStart.end() - 1);
+    for (uint64_t i = 0; i < keyCount; i++) {
+        members[fill[groupFor(hashes[i], groupCount)]++] = i;
+    }
+
+    std::vector<uint64_t> order(groupCount);
+    for (uint64_t g = 0; g < groupCount; g++) {
+        order[g] = g;
+    }
+    std::stable_sort(order.begin(), order.end(), [&groupStart](uint64_t a, uint64_t b) {
+        return groupStart[a + 1] - groupStart[a] > groupStart[b + 1] - groupStart[b];
+    });
+
+    std::vector<bool> taken(keyCount, false);
+    std::vector<uint64_t> slots;
+    for (uint64_t g : order) {
+        uint64_t first = groupStart[g];
+        uint64_t last = groupStart[g + 1];
+        pilots[g] = 0;
+        if (first == last) {
+            continue;
+        }
+        //Keys with equal hashes would land together under every pilot
+        for (uint64_t a = first; a < last; a++) {
+            for (uint64_t b = a + 1; b < last; b++) {
+                if (hashes[members[a]] == hashes[members[b]]) {
+                    return false;
+                }
+            }
+        }
+
+        bool placed = false;
+        for (uint64_t pilot = 0; pilot <= std::numeric_limits<uint32_t>::max() and !placed; pilot++) {
+            slots.clear();
+            placed = true;
+            for (uint64_t m = first; m < last and placed; m++) {
+                uint64_t slot = slotFor(hashes[members[m]], static_cast<uint32_t>(pilot), seed, keyCount);
+                placed = !taken[slot] and std::find(slots.begin(), slots.end(), slot) == slots.end();
+                slots.push_back(slot);
+            }
+            if (placed) {
+                pilots[g] = static_cast<uint32_t>(pilot);
+                for (uint64_t m = first; m < last; m++) {
+                    taken[slots[m - first]] = true;
+                    slotOf[members[m]] = slots[m - first];
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+/**
+* FrozenHashTable constructor: Starts with no file open, every lookup misses
+*/
+FrozenHashTable::FrozenHashTable() {
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+#ifdef _WIN32
+    this->fileHandle = nullptr;
+    this->mapHandle = nullptr;
+#endif
+    this->header = nullptr;
+    this->pilots = nullptr;
+    this->slots = nullptr;
+    this->keyBlob = nullptr;
+}
+
+/**
+* FrozenHashTable destructor: Unmaps the open file
+*/
+FrozenHashTable::~FrozenHashTable() {
+    this->close();
+}
+
+/**
+* FrozenHashTable move constructor: Takes over the other table's mapping
+*
+* param :
+*   other: the table to take the mapping from, left with no file open
+*/
+FrozenHashTable::FrozenHashTable(FrozenHashTable&& other) noexcept : FrozenHashTable() {
+    *this = std::move(other);
+}
+
+/**
+* FrozenHashTable move assignment: Unmaps this table's file and takes over the other table's mapping
+*
+* param :
+*   other: the table to take the mapping from, left with no file open
+*/
+FrozenHashTable& FrozenHashTable::operator=(FrozenHashTable&& other) noexcept {
+    if (this != &other) {
+        this->close();
+        this->mapping = std::exchange(other.mapping, nullptr);
+        this->mappingSize = std::exchange(other.mappingSize, 0);
+#ifdef _WIN32
+        this->fileHandle = std::exchange(other.fileHandle, nullptr);
+        this->mapHandle = std::exchange(other.mapHandle, nullptr);
+#endif
+        this->header = std::exchange(other.header, nullptr);
+        this->pilots = std::exchange(other.pilots, nullptr);
+        this->slots = std::exchange(other.slots, nullptr);
+        this->keyBlob = std::exchange(other.keyBlob, nullptr);
+        this->hasher = other.hasher;
+    }
+    return *this;
+}
+
+/**
+* write: build the minimal perfect hash for every key of a table and write the frozen file. The file
+*   is a Header, the pilot of each group, one Slot per key in slot order and the bytes of every key
+*   in the same order. Offsets in the header are from the start of the file and numbers are in this
+*   machine's byte order.
+*
+* param :
+*   table: the table to freeze
+*   path: the file to write, replaced if it exists
+*
+* returns:
+*   bool: true if the file was written, false if it could not be or no seed gave a perfect hash
+*/
+bool FrozenHashTable::write(const HashTable& table, const std::string& path) {
+    std::vector<std::string_view> keys;
+    std::vector<uint64_t> values;
+    keys.reserve(table.size());
+    values.reserve(table.size());
+    for (const auto& [key, value] : table) {
+        //Slots store key lengths in 32 bits
+        if (key.size() > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        keys.push_back(key);
+        values.push_back(value);
+    }
+
+    uint64_t keyCount = keys.size();
+    uint64_t groupCount = (keyCount + KEYS_PER_GROUP - 1) / KEYS_PER_GROUP;
+    std::vector<uint64_t> hashes(keyCount);
+    std::vector<uint32_t> pilots(groupCount);
+    std::vector<uint64_t> slotOf(keyCount);
+    uint64_t seed = randomSeed();
+    bool placed = keyCount == 0;
+    for (size_t attempt = 0; attempt < MAX_SEED_TRIES and !placed; attempt++) {
+        seed = randomSeed();
+        WyHash hasher(seed);
+        for (uint64_t i = 0; i < keyCount; i++) {
+            hashes[i] = hasher(keys[i]);
+        }
+        placed = findPilots(hashes, groupCount, seed, pilots, slotOf);
+    }
+    if (!placed) {
+        return false;
+    }
+
+    std::vector<uint64_t> keyAt(keyCount);
+    for (uint64_t i = 0; i < keyCount; i++) {
+        keyAt[slotOf[i]] = i;
+    }
+    std::vector<Slot> slots(keyCount);
+    uint64_t keyBlobBytes = 0;
+    for (uint64_t s = 0; s < keyCount; s++) {
+        uint64_t i = keyAt[s];
+        slots[s] = {keyBlobBytes, values[i], static_cast<uint32_t>(keys[i].size()), static_cast<uint32_t>(hashes[i] >> 32)};
+        keyBlobBytes += keys[i].size();
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.seed = seed;
+    header.keyCount = keyCount;
+    header.groupCount = groupCount;
+    header.pilotOffset = sizeof(Header);
+    //Slots hold 64 bit fields, so they start on an 8 byte boundary
+    header.slotOffset = (header.pilotOffset + groupCount * sizeof(uint32_t) + 7) & ~uint64_t(7);
+    header.keyBlobOffset = header.slotOffset + keyCount * sizeof(Slot);
+    header.keyBlobBytes = keyBlobBytes;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(pilots.data()), static_cast<std::streamsize>(groupCount * sizeof(uint32_t)));
+    const char padding[8] = {};
+    out.write(padding, static_cast<std::streamsize>(header.slotOffset - header.pilotOffset - groupCount * sizeof(uint32_t)));
+    out.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(keyCount * sizeof(Slot)));
+    for (uint64_t s = 0; s < keyCount; s++) {
+        std::string_view key = keys[keyAt[s]];
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+    }
+    out.flush();
+    return out.good();
+}
+
+/**
+* open: map a file written by write() and check its header. The keys and values are not read, pages
+*   are only brought in as lookups touch them. If the file cannot be mapped or its header does not
+*   check out, the file that was open before stays open.
+*
+* param :
+*   path: the frozen file to map
+*
+* returns:
+*   bool: true if the file is now the one lookups are answered from
+*/
+bool FrozenHashTable::open(const std::string& path) {
+    FrozenHashTable opened;
+#ifdef _WIN32
+    opened.fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (opened.fileHandle == INVALID_HANDLE_VALUE) {
+        opened.fileHandle = nullptr;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(opened.fileHandle, &fileSize) or static_cast<uint64_t>(fileSize.QuadPart) < sizeof(Header)) {
+        return false;
+    }
+    opened.mapHandle = CreateFileMappingA(opened.fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (opened.mapHandle == nullptr) {
+        return false;
+    }
+    opened.mapping = static_cast<const char*>(MapViewOfFile(opened.mapHandle, FILE_MAP_READ, 0, 0, 0));
+    if (opened.mapping == nullptr) {
+        return false;
+    }
+    opened.mappingSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 or static_cast<uint64_t>(fileStatus.st_size) < sizeof(Header)) {
+        ::close(file);
+        return false;
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, file, 0);
+    //The mapping keeps the file alive on its own
+    ::close(file);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    opened.mapping = static_cast<const char*>(address);
+    opened.mappingSize = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+    const Header* header = reinterpret_cast<const Header*>(opened.mapping);
+    uint64_t fileSize = opened.mappingSize;
+    //Sizes are checked with divisions first so a damaged header cannot overflow the range checks
+    if (std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 or header->version != VERSION or
+        header->byteOrder != BYTE_ORDER_MARK or header->groupCount != (header->keyCount + KEYS_PER_GROUP - 1) / KEYS_PER_GROUP or
+        header->pilotOffset % alignof(uint32_t) != 0 or header->slotOffset % alignof(Slot) != 0 or
+        header->pilotOffset > fileSize or header->groupCount > (fileSize - header->pilotOffset) / sizeof(uint32_t) or
+        header->slotOffset > fileSize or header->keyCount > (fileSize - header->slotOffset) / sizeof(Slot) or
+        header->keyBlobOffset > fileSize or header->keyBlobBytes > fileSize - header->keyBlobOffset) {
+        return false;
+    }
+
+    opened.header = header;
+    opened.pilots = reinterpret_cast<const uint32_t*>(opened.mapping + header->pilotOffset);
+    opened.slots = reinterpret_cast<const Slot*>(opened.mapping + header->slotOffset);
+    opened.keyBlob = opened.mapping + header->keyBlobOffset;
+    opened.hasher = WyHash(header->seed);
+    *this = std::move(opened);
+    return true;
+}
+
+/**
+* close: unmap the open file, if there is one
+*/
+void FrozenHashTable::close() {
+#ifdef _WIN32
+    if (this->mapping != nullptr) {
+        UnmapViewOfFile(this->mapping);
+    }
+    if (this->mapHandle != nullptr) {
+        CloseHandle(this->mapHandle);
+    }
+    if (this->fileHandle != nullptr) {
+        CloseHandle(this->fileHandle);
+    }
+    this->fileHandle = nullptr;
+    this->mapHandle = nullptr;
+#else
+    if (this->mapping != nullptr) {
+        munmap(const_cast<char*>(this->mapping), this->mappingSize);
+    }
+#endif
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->header = nullptr;
+    this->pilots = nullptr;
+    this->slots = nullptr;
+    this->keyBlob = nullptr;
+}
+
+/**
+* isOpen: check if a frozen file is mapped
+*
+* returns:
+*   bool: true if lookups are answered from a file
+*/
+bool FrozenHashTable::isOpen() const {
+    return this->header != nullptr;
+}
+
+/**
+* contains: Check if key is in the frozen table
+*
+* param :
+*   key: the key to look for
+*
+* returns:
+*   bool: true if it is in the table false if it is not
+*/
+bool FrozenHashTable::contains(std::string_view key) const {
+    return this->get(key).has_value();
+}
+
+/**
+* get: look a key up. The key's group pilot picks its only possible slot, which either holds the key
+*   or shows it is not in the table.
+*
+* param :
+*   key: the key to look for
+*
+* returns:
+*   std::optional<size_t>: Value of key if it is in the table or nullopt if key is not in table
+*/
+std::optional<size_t> FrozenHashTable::get(std::string_view key) const {
+    if (this->header == nullptr or this->header->keyCount == 0) {
+        return std::nullopt;
+    }
+
+    uint64_t hashValue = this->hasher(key);
+    uint32_t pilot = this->pilots[groupFor(hashValue, this->header->groupCount)];
+    const Slot& slot = this->slots[slotFor(hashValue, pilot, this->header->seed, this->header->keyCount)];
+    if (slot.hashCheck != static_cast<uint32_t>(hashValue >> 32) or slot.keyLength != key.size()) {
+        return std::nullopt;
+    }
+    //Keys are only range checked here, when they are used, so opening a file does not read all of it
+    if (slot.keyOffset > this->header->keyBlobBytes or slot.keyLength > this->header->keyBlobBytes - slot.keyOffset or
+        std::memcmp(this->keyBlob + slot.keyOffset, key.data(), key.size()) != 0) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(slot.value);
+}
+
+/**
+* size: get the number of keys in the frozen table
+*
+* returns:
+*   size_t: number of keys, 0 if no file is open
+*/
+size_t FrozenHashTable::size() const {
+    return this->header != nullptr ? static_cast<size_t>(this->header->keyCount) : 0;
+}
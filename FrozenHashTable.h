@@ -0,0 +1,80 @@
+#pragma once
+
+#include "HashTable.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+/**
+ * FrozenHashTable.h
+ *
+ * Read-only string to size_t table for lookup data built offline. write() turns a HashTable into a
+ * file and open() memory maps that file and answers lookups straight out of the mapping, so there is
+ * nothing to deserialize and every process that opens the same file shares one copy in the page
+ * cache. The file only holds offsets, never pointers, so it works wherever it is mapped.
+ *
+ * Keys are placed with a minimal perfect hash (hash and displace, as in CHD and PTHash): a key's hash
+ * picks one of about n/3 groups, each group stores a pilot number, and the key's hash mixed with its
+ * group's pilot gives its slot. Pilots are searched for at build time until every one of the n keys
+ * has a slot of its own among exactly n slots. A lookup reads one pilot and one slot, then compares
+ * the key against the one stored there.
+ */
+class FrozenHashTable {
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint64_t seed;
+            uint64_t keyCount;
+            uint64_t groupCount;
+            uint64_t pilotOffset;
+            uint64_t slotOffset;
+            uint64_t keyBlobOffset;
+            uint64_t keyBlobBytes;
+        };
+
+        //hashCheck is the top half of the key's hash, most misses are turned away without reading the key
+        struct Slot {
+            uint64_t keyOffset;
+            uint64_t value;
+            uint32_t keyLength;
+            uint32_t hashCheck;
+        };
+
+        static constexpr char MAGIC[8] = {'H', 'T', 'F', 'R', 'O', 'Z', 'E', 'N'};
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+        static constexpr size_t KEYS_PER_GROUP = 3;
+        static constexpr size_t MAX_SEED_TRIES = 16;
+
+        const char* mapping;
+        size_t mappingSize;
+#ifdef _WIN32
+        void* fileHandle;
+        void* mapHandle;
+#endif
+        const Header* header;
+        const uint32_t* pilots;
+        const Slot* slots;
+        const char* keyBlob;
+        WyHash hasher;
+
+        void close();
+
+    public:
+        FrozenHashTable();
+        ~FrozenHashTable();
+        FrozenHashTable(FrozenHashTable&& other) noexcept;
+        FrozenHashTable& operator=(FrozenHashTable&& other) noexcept;
+        FrozenHashTable(const FrozenHashTable&) = delete;
+        FrozenHashTable& operator=(const FrozenHashTable&) = delete;
+
+        static bool write(const HashTable& table, const std::string& path);
+        bool open(const std::string& path);
+        bool isOpen() const;
+        bool contains(std::string_view key) const;
+        std::optional<size_t> get(std::string_view key) const;
+        size_t size() const;
+};
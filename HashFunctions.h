@@ -0,0 +1,254 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string_view>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+/**
+ * HashFunctions.h
+ *
+ * Seeded hash functions for the tables. WyHash is the fast default: it reads 8 or 16 bytes at a time
+ * and finishes with one 64x64 -> 128 bit multiply. Every table gets its own random seed, so which keys
+ * collide differs between tables and between runs. That stops casual collision attacks, but an
+ * attacker who can watch timings may still recover enough to craft collisions. SipHash-2-4 is a keyed
+ * PRF built for that case: it is slower, and its output cannot be predicted without the 128 bit key.
+ * Use it as the Hash of a table whose keys come from untrusted input.
+ *
+ * Both functors hash strings through std::string_view, unsigned and signed integers by value, and
+ * carry their seed with them, so copying a table keeps its hashes valid.
+ */
+
+/**
+* randomSeed: get a new random 64 bit seed. Each thread seeds a splitmix64 sequence from
+*   std::random_device once and then steps it, since random_device can cost a system call per call
+*   and a seed is needed for every table made.
+*
+* returns:
+*   uint64_t: a seed that differs between calls, threads and runs
+*/
+inline uint64_t randomSeed() {
+    thread_local uint64_t state = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+    state += 0x9e3779b97f4a7c15ULL;
+    uint64_t mixed = state;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    return mixed ^ (mixed >> 31);
+}
+
+/**
+ * WyHash: the final version 4 of Wang Yi's wyhash, with the default secret. Not keyed strongly
+ * enough to resist an attacker who can observe the table, see SipHash for that.
+ */
+class WyHash {
+    private:
+        static constexpr uint64_t SECRET[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                               0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+        uint64_t seed;
+
+        //64x64 bit multiply, low half back in a and high half in b
+        static void multiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            a = static_cast<uint64_t>(product);
+            b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            a = _umul128(a, b, &b);
+#else
+            uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a), bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+            uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+            uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+            a = (middle << 32) | static_cast<uint32_t>(lowLow);
+            b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+        }
+
+        static uint64_t mix(uint64_t a, uint64_t b) {
+            multiply(a, b);
+            return a ^ b;
+        }
+
+        static uint64_t read8(const unsigned char* bytes) {
+            uint64_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+        static uint64_t read4(const unsigned char* bytes) {
+            uint32_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+    public:
+        //Seeded from randomSeed(), so two tables made with the default hash disagree on every hash
+        WyHash() : seed(randomSeed()) {}
+
+        explicit WyHash(uint64_t seed) : seed(seed) {}
+
+        /**
+        * operator(): hash a string's bytes
+        *
+        * param :
+        *   key: the bytes to hash
+        *
+        * returns:
+        *   size_t: hash of the bytes under this functor's seed
+        */
+        size_t operator()(std::string_view key) const {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.data());
+            size_t length = key.size();
+            uint64_t state = this->seed ^ mix(this->seed ^ SECRET[0], SECRET[1]);
+            uint64_t a;
+            uint64_t b;
+            if (length <= 16) {
+                if (length >= 4) {
+                    size_t middle = (length >> 3) << 2;
+                    a = (read4(bytes) << 32) | read4(bytes + middle);
+                    b = (read4(bytes + length - 4) << 32) | read4(bytes + length - 4 - middle);
+                }
+                else if (length > 0) {
+                    a = (static_cast<uint64_t>(bytes[0]) << 16) | (static_cast<uint64_t>(bytes[length >> 1]) << 8) | bytes[length - 1];
+                    b = 0;
+                }
+                else {
+                    a = 0;
+                    b = 0;
+                }
+            }
+            else {
+                size_t remaining = length;
+                if (remaining > 48) {
+                    //Three independent lanes so the multiplies can overlap
+                    uint64_t lane1 = state;
+                    uint64_t lane2 = state;
+                    do {
+                        state = mix(read8(bytes) ^ SECRET[1], read8(bytes + 8) ^ state);
+                        lane1 = mix(read8(bytes + 16) ^ SECRET[2], read8(bytes + 24) ^ lane1);
+                        lane2 = mix(read8(bytes + 32) ^ SECRET[3], read8(bytes + 40) ^ lane2);
+                        bytes += 48;
+                        remaining -= 48;
+                    } while (remaining > 48);
+                    state ^= lane1 ^ lane2;
+                }
+                while (remaining > 16) {
+                    state = mix(read8(bytes) ^ SECRET[1], read8(bytes + 8) ^ state);
+                    bytes += 16;
+                    remaining -= 16;
+                }
+                //The last 16 bytes of the key, which may overlap ones already mixed in
+                a = read8(bytes + remaining - 16);
+                b = read8(bytes + remaining - 8);
+            }
+            a ^= SECRET[1];
+            b ^= state;
+            multiply(a, b);
+            return static_cast<size_t>(mix(a ^ SECRET[0] ^ length, b ^ SECRET[1]));
+        }
+
+        /**
+        * operator(): hash an integer by value (wyhash64 of the integer and the seed)
+        */
+        template <std::integral Integer>
+        size_t operator()(Integer key) const {
+            uint64_t a = static_cast<uint64_t>(key) ^ SECRET[0];
+            uint64_t b = this->seed ^ SECRET[1];
+            multiply(a, b);
+            return static_cast<size_t>(mix(a ^ SECRET[0], b ^ SECRET[1]));
+        }
+};
+
+/**
+ * SipHash: SipHash-2-4 keyed with 128 random bits per table. Without the key the hash of any input
+ * cannot be guessed, so inputs cannot be picked to collide.
+ */
+class SipHash {
+    private:
+        uint64_t key0;
+        uint64_t key1;
+
+        static void round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+            v0 += v1;
+            v1 = std::rotl(v1, 13);
+            v1 ^= v0;
+            v0 = std::rotl(v0, 32);
+            v2 += v3;
+            v3 = std::rotl(v3, 16);
+            v3 ^= v2;
+            v0 += v3;
+            v3 = std::rotl(v3, 21);
+            v3 ^= v0;
+            v2 += v1;
+            v1 = std::rotl(v1, 17);
+            v1 ^= v2;
+            v2 = std::rotl(v2, 32);
+        }
+
+    public:
+        SipHash() : key0(randomSeed()), key1(randomSeed()) {}
+
+        SipHash(uint64_t key0, uint64_t key1) : key0(key0), key1(key1) {}
+
+        /**
+        * operator(): hash a string's bytes
+        *
+        * param :
+        *   key: the bytes to hash
+        *
+        * returns:
+        *   size_t: SipHash-2-4 of the bytes under this functor's key
+        */
+        size_t operator()(std::string_view key) const {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.data());
+            size_t length = key.size();
+            uint64_t v0 = this->key0 ^ 0x736f6d6570736575ULL;
+            uint64_t v1 = this->key1 ^ 0x646f72616e646f6dULL;
+            uint64_t v2 = this->key0 ^ 0x6c7967656e657261ULL;
+            uint64_t v3 = this->key1 ^ 0x7465646279746573ULL;
+
+            size_t wholeWords = length & ~size_t(7);
+            for (size_t i = 0; i < wholeWords; i += 8) {
+                uint64_t word;
+                std::memcpy(&word, bytes + i, sizeof(word));
+                v3 ^= word;
+                round(v0, v1, v2, v3);
+                round(v0, v1, v2, v3);
+                v0 ^= word;
+            }
+
+            //The last partial word is padded with zeros and topped with the length's low byte
+            uint64_t last = static_cast<uint64_t>(length) << 56;
+            for (size_t i = wholeWords; i < length; i++) {
+                last |= static_cast<uint64_t>(bytes[i]) << (8 * (i - wholeWords));
+            }
+            v3 ^= last;
+            round(v0, v1, v2, v3);
+            round(v0, v1, v2, v3);
+            v0 ^= last;
+            v2 ^= 0xff;
+            for (int i = 0; i < 4; i++) {
+                round(v0, v1, v2, v3);
+            }
+            return static_cast<size_t>(v0 ^ v1 ^ v2 ^ v3);
+        }
+
+        /**
+        * operator(): hash an integer by value, as the 8 little endian bytes of the integer
+        */
+        template <std::integral Integer>
+        size_t operator()(Integer key) const {
+            unsigned char bytes[8];
+            uint64_t value = static_cast<uint64_t>(key);
+            for (unsigned char& byte : bytes) {
+                byte = static_cast<unsigned char>(value);
+                value >>= 8;
+            }
+            return (*this)(std::string_view(reinterpret_cast<const char*>(bytes), sizeof(bytes)));
+        }
+};
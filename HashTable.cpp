@@ -5,402 +5,230 @@
 #include "HashTable.h"
 
 #include <algorithm>
-#include <optional>
+#include <atomic>
 #include <string>
+#include <utility>
 
 /**
-*  HashTableBucket default constructor: Sets the bucket created to empty since start
-*/
-HashTableBucket::HashTableBucket() {
-    this->setBucketType(BucketType::ESS);
-};
-/**
-* HashTableBucket parameterized constructor: Initialize the key and value
-* and set bucketType to normal via load method
-*
-* params:
-*   key: the key you want to insert into the bucket
-*   value: the value that should be in the bucket
-*/
-HashTableBucket::HashTableBucket(std::string key, int value) {
-    this->load(key, value);
-};
-
-/**
-* Load: load the given key and value into the bucket's fields
-*
-* params:
-*   key: the key you want to have in the bucket
-*   value: the value that should be in the bucket
-*/
-void HashTableBucket::load(std::string key, int value) {
-    this->setBucketType(BucketType::NORMAL);
-    this->key = key;
-    this->value= value;
-};
-
-/**
-* isEmpty: checks the bucket type to see if it is empty or not
+* KeyArena constructor: Starts with no slabs, the first key stored allocates one
 *
-* return :
-*   bool is the bucket not of type empty since start or empty after remove
+* param :
+*   resource: where slabs are allocated from
 */
-bool HashTableBucket::isEmpty() const {
-    if ((this->type == BucketType::ESS) or (this->type == BucketType::EAR)){
-        return true;
-    }
-    else {
-        return false;
-    }
+KeyArena::KeyArena(std::pmr::memory_resource* resource) {
+    this->resource = resource;
+    this->cursor = nullptr;
+    this->remaining = 0;
+    this->usedBytes = 0;
 }
 
 /**
-* isEmptySinceStart: checks the bucket type to see if it is emptySinceStart
-*
-* return :
-*   bool is the bucket not of type empty since start
+* KeyArena destructor: Gives every slab back to the resource it came from
 */
-bool HashTableBucket::isEmptySinceStart() const {
-    if (this->type == BucketType::ESS){
-        return true;
-    }
-    else {
-        return false;
-    }
+KeyArena::~KeyArena() {
+    this->clear();
 }
 
 /**
-* setBucketType: sets the bucket type
+* KeyArena move constructor: Takes over the other arena's slabs, keys stored in them stay valid. Both
+*   arenas allocate from the other's resource afterwards.
 *
 * param :
-*   BucketType: is the bucket type you are going to set the bucket to
+*   other: the arena to take the slabs from, left empty
 */
-void HashTableBucket::setBucketType(BucketType type) const{
-    this->type = type;
+KeyArena::KeyArena(KeyArena&& other) noexcept {
+    this->slabs = std::move(other.slabs);
+    this->resource = other.resource;
+    this->cursor = std::exchange(other.cursor, nullptr);
+    this->remaining = std::exchange(other.remaining, 0);
+    this->usedBytes = std::exchange(other.usedBytes, 0);
+    other.slabs.clear();
 }
 
 /**
-* getKey: gets value of the key field
+* KeyArena move assignment: Frees this arena's slabs and takes over the other arena's. New slabs still
+*   come from this arena's own resource, like a pmr container that keeps its allocator.
 *
-* return :
-*   std:string: is the buckets key field value
+* param :
+*   other: the arena to take the slabs from, left empty
 */
-std::string HashTableBucket::getKey() const{
-    return this->key;
+KeyArena& KeyArena::operator=(KeyArena&& other) noexcept {
+    if (this != &other) {
+        this->clear();
+        this->slabs = std::move(other.slabs);
+        this->cursor = std::exchange(other.cursor, nullptr);
+        this->remaining = std::exchange(other.remaining, 0);
+        this->usedBytes = std::exchange(other.usedBytes, 0);
+        other.slabs.clear();
+    }
+    return *this;
 }
 
 /**
-* getValueRef: gets reference to the value field
+* allocateSlab: get a slab of the given size from the arena's resource and remember it
 *
-* return :
-*   size_t&: is the buckets value field reference
-*/
-size_t& HashTableBucket::getValueRef(){
-    return this->value;
-}
-
-/**
-* getValue: gets value of the value field
+* param :
+*   bytes: size of the slab
 *
-* return :
-*   size_t: is the buckets value field value
+* returns:
+*   char*: the start of the slab
 */
-size_t HashTableBucket::getValue() const{
-    return this->value;
+char* KeyArena::allocateSlab(size_t bytes) {
+    char* slab = static_cast<char*>(this->resource->allocate(bytes, 1));
+    this->slabs.push_back({slab, bytes, this->resource});
+    return slab;
 }
 
 /**
-* HashTable constructor: Takes a capacity and initializes the size, capacity values. Also initalizes the
-*   probeOffsets and tableData vectors.
+* store: copy a key's bytes into the arena. Keys bigger than a quarter slab get a slab of their own
+*   so they do not waste the rest of the current one.
 *
 * param :
-*   initCapacity: defaults to 8 but is the base HashTable capacity otherwise
-*/
-HashTable::HashTable(size_t initCapacity) {
-    this->numCapacity = initCapacity;
-    this->numSize = 0;
-    tableData.resize(initCapacity);
-    probeOffsets = this->setUpProbeOffsets(true);
-}
-
-/**
-* insert: Inserts a new key-value pair into the hashTable. If the key is already in the table
-*   than it is not inserted. If the alpha of the table (size/capacity) exceeds .5 the table
-*   is resized to double its current size and the elements are reinput under a new probe
-*   offset vector.
+*   key: the key to copy
 *
-* param :
-*   key: the key to input into the table
-*   value: the value associated with the key
+* returns:
+*   std::string_view: the copied key, valid until the arena is cleared
 */
-bool HashTable::insert(std::string key, size_t value) {
-    bool result = false;
-
-    //return false
-    if (this->contains(key)) {
-        return result;
+std::string_view KeyArena::store(std::string_view key) {
+    if (key.empty()) {
+        return {};
     }
+    this->usedBytes += key.size();
 
-    //Hash current key to find home position of this key
-    size_t home = hash(key);
-    //Probe for proper location to insert key value pair
-    for (size_t i = 0; i < this->capacity(); i++) {
-        size_t vectorIndex = (home + probeOffsets[i]) % this->capacity();
-
-        //If the current buckey is = to the current key and is not marked as break return out of loop
-        if (tableData.at(vectorIndex).getKey() == key && !tableData.at(vectorIndex).isEmpty()) {
-            result = false;
-            break;
-        }
-
-        //If empty load data into bucket and return out of fuction
-        if (tableData.at(vectorIndex).isEmpty()) {
-            tableData.at(vectorIndex).load(key, value);
-            this->numSize++;
-            result = true;
-            break;
-        }
+    if (key.size() > SLAB_SIZE / 4) {
+        char* slab = this->allocateSlab(key.size());
+        std::copy(key.begin(), key.end(), slab);
+        return {slab, key.size()};
     }
 
-    //Resize vector if load rating is greater than 0.5 NEED TO REMAP INTS STILL
-    if (this->alpha() > 0.5) {
-        //Make new vector table and insert current keys into it with new locations based off resize.
-        //Set tableData to this new vector at end so that it has the new locations
-        std::vector<size_t> newProbeOffsets = this->setUpProbeOffsets(false);
-        std::vector<HashTableBucket> newDataTable;
-        newDataTable.resize(this->capacity() * 2);
-        std::vector<std::string> curKeyList = this->keys();
-
-        //Go through current list and find where the key is and find a new location for each key in list
-        for (int i = 0; i < curKeyList.capacity(); i++) {
-            size_t curKeyIndex = this->getIndex(curKeyList[i]).value();
-            std::string curKey = this->tableData.at(curKeyIndex).getKey();
-            int curValue = this->tableData.at(curKeyIndex).getValue();
-
-            size_t home = hash(curKey);
-            //Probe for proper location to insert key value pair
-            for (size_t i = 0; i < newDataTable.capacity(); i++) {
-                size_t vectorIndex = (home + newProbeOffsets[i]) % newDataTable.capacity();
-
-                //If empty load data into bucket and return out of fuction
-                if (newDataTable.at(vectorIndex).isEmpty()) {
-                    newDataTable.at(vectorIndex).load(curKey, curValue);
-                    break;
-                }
-            }
-        }
-
-        //Swap out old tables for new ones
-        this->tableData.clear();
-        this->tableData = newDataTable;
-        this->probeOffsets.clear();
-        this->probeOffsets = newProbeOffsets;
-        this->numCapacity *= 2;
+    if (key.size() > this->remaining) {
+        this->cursor = this->allocateSlab(SLAB_SIZE);
+        this->remaining = SLAB_SIZE;
     }
-    return result;
+    char* start = this->cursor;
+    std::copy(key.begin(), key.end(), start);
+    this->cursor += key.size();
+    this->remaining -= key.size();
+    return {start, key.size()};
 }
 
 /**
-* remove: Check if key is in table if it is set the bucket it was in to empty after removal
+* allocateBlock: get a slab of its own for bytes the caller fills in, such as a snapshot's key blob.
+*   The bytes count as used and stay valid until the arena is cleared.
 *
 * param :
-*   key: the key to check for in the table
-*/
-bool HashTable::remove(std::string key) {
-    //Check if current key is in list
-    if (std::optional<int> curKey = this->getIndex(key); curKey != std::nullopt) {
-        //Set bucket type to empty after removal
-        this->tableData.at(curKey.value()).setBucketType(BucketType::EAR);
-        //Lower current size
-        numSize--;
-        return true;
-    }
-    else {
-        return false;
-    }
-}
-
-/**
-* contains: Check if key is in table
-*
-* param :
-*   key: reference to the key to check for in the table
+*   bytes: the size of the block
 *
 * returns:
-*   bool: true if it is in container false if it is not
+*   char*: the start of the block
 */
-bool HashTable::contains(const std::string& key) const {
-    //Find index of current key if it is not nullopt the bucket is in the lust
-    if (this->getIndex(key) != std::nullopt) {
-        return true;
-    }
-    return false;
+char* KeyArena::allocateBlock(size_t bytes) {
+    this->usedBytes += bytes;
+    return bytes == 0 ? nullptr : this->allocateSlab(bytes);
 }
 
 /**
-* get: Check if key is in table and return the value
+* merge: take over every slab of another arena, for keys stored by other threads. Keys stored in
+*   either arena stay valid, and new keys keep going into this arena's current slab.
 *
 * param :
-*   key: reference to the key to check for in the table
-*
-* returns:
-*   std::optional<int>: Value of key if it is in the table or nullopt if key is not in table
+*   other: the arena to take the slabs from, left empty
 */
-std::optional<int> HashTable::get(const std::string& key) const {
-    //Grab keys current index and make sure it is not nullopt
-    if (std::optional<int> curKey = this->getIndex(key); curKey != std::nullopt) {
-        //Return keys value
-        return this->tableData.at(curKey.value()).getValue();
-    }
-    else {
-        return std::nullopt;
-    }
+void KeyArena::merge(KeyArena&& other) {
+    this->slabs.insert(this->slabs.end(), other.slabs.begin(), other.slabs.end());
+    this->usedBytes += other.usedBytes;
+    other.slabs.clear();
+    other.clear();
 }
 
 /**
-* operator []: Check if key is in table and return the reference to the value for assignment purpouses
-*
-* param :
-*   key: reference to the key to check for in the table
-*
-* returns:
-*   size_t&: Reference to value of key if it is in the table or nothing if it is not in the table
+* clear: free every slab, all keys stored in the arena become invalid
 */
-size_t& HashTable::operator[](const std::string& key) {
-    //Check if key is in list
-    if (std::optional<int> curKey = this->getIndex(key); curKey != std::nullopt) {
-        //If key is in list return the reference to the current value for assignment or getter
-        size_t& ref = this->tableData.at(curKey.value()).getValueRef();
-        return ref;
+void KeyArena::clear() {
+    for (const Slab& slab : this->slabs) {
+        slab.resource->deallocate(slab.bytes, slab.size, 1);
     }
+    this->slabs.clear();
+    this->cursor = nullptr;
+    this->remaining = 0;
+    this->usedBytes = 0;
 }
 
 /**
-* keys: Get list of all buckets that are normal in table
+* bytesUsed: get the number of key bytes stored, including keys that were removed since
 *
 * returns:
-*   std::vector<std::string>: List of all non empty buckets keys
+*   size_t: total bytes of every key stored
 */
-std::vector<std::string> HashTable::keys() const {
-    std::vector<std::string> curKeyList;
-    curKeyList.resize(this->size());
-    int curKeyIndex = 0;
-    //Search length of vector for if a buckey is empty or not
-    for (size_t i = 0; i < this->capacity(); i++) {
-        if (!this->tableData.at(i).isEmpty()) {
-            //If not empty add to list and up the index
-            curKeyList[curKeyIndex] = this->tableData.at(i).getKey();
-            curKeyIndex++;
-        }
-    }
-    return curKeyList;
+size_t KeyArena::bytesUsed() const {
+    return this->usedBytes;
 }
 
 /**
-* alpha: get the load factor of the vector table comprised of size/capacity
+* BloomFilter constructor: Starts with no blocks, which lets every key through until reset() sizes it
 *
-* returns:
-*   double: size/capacity
+* param :
+*   resource: where the blocks are allocated from
 */
-double HashTable::alpha() const {
-    return static_cast<double>(this->size())/static_cast<double>(this->capacity());
-}
+BloomFilter::BloomFilter(std::pmr::memory_resource* resource) : blocks(resource), keyCapacity(0) {}
 
 /**
-* capacity: Get capacity of bucket (total number of buckets)
+* reset: empty the filter and size it for a number of keys
 *
-* returns:
-*   size_t: Number of total buckets
+* param :
+*   keyCount: how many keys the filter should hold at BITS_PER_KEY bits each
 */
-size_t HashTable::capacity() const {
-    return this->numCapacity;
+void BloomFilter::reset(size_t keyCount) {
+    size_t blockCount = std::max<size_t>((keyCount * BITS_PER_KEY + 511) / 512, 1);
+    this->blocks.assign(blockCount, Block{});
+    this->keyCapacity = keyCount;
 }
 
 /**
-* size: Returns number of buckets that are not empty
-*
-* returns:
-*   size_t: List of all non empty buckets keys
+* clear: free the blocks, the filter lets every key through until it is reset
 */
-size_t HashTable::size() const {
-    return this->numSize;
+void BloomFilter::clear() {
+    std::pmr::vector<Block>(this->blocks.get_allocator()).swap(this->blocks);
+    this->keyCapacity = 0;
 }
 
 /**
-* hash: Use internal hash function to convert string into hashed value
+* addShared: set a key's bits while other threads may be adding keys too
 *
-* returns:
-*   size_t: Hashed value of key
+* param :
+*   hashValue: the key's hash
 */
-size_t HashTable::hash(std::string key) const {
-    return std::hash<std::string>{}(key);
+void BloomFilter::addShared(uint64_t hashValue) {
+    if (this->blocks.empty()) {
+        return;
+    }
+    Block& block = const_cast<Block&>(this->blockFor(hashValue));
+    uint32_t low = static_cast<uint32_t>(hashValue);
+    for (size_t i = 0; i < 8; i++) {
+        std::atomic_ref<uint64_t>(block.words[i]).fetch_or(uint64_t(1) << ((low * SALTS[i]) >> 26), std::memory_order_relaxed);
+    }
 }
 
 /**
-* getIndex: get index returns the index of where a key should be placed
+* capacity: get how many keys the filter was sized for
 *
 * returns:
-*   std::optional<int>: Possible index of key
+*   size_t: the key count passed to the last reset, 0 if it has no blocks
 */
-std::optional<int> HashTable::getIndex(const std::string& key) const {
-    size_t home = hash(key);
-    //Probe for proper location to remove key value pair
-    for (size_t i = 0; i < this->capacity(); i++) {
-        size_t vectorIndex = (home + probeOffsets[i]) % this->capacity();
-
-        //If key matches and bucket is not empty then return index
-        if ((this->tableData.at(vectorIndex).getKey() == key) and (!this->tableData.at(vectorIndex).isEmpty())) {
-            return vectorIndex;
-        }
-
-        //If you found an empty bucket return nullopt the key is not in the vector table
-        if (this->tableData[vectorIndex].isEmptySinceStart()) {
-            return std::nullopt;
-        }
-    }
-    return std::nullopt;
+size_t BloomFilter::capacity() const {
+    return this->keyCapacity;
 }
 
 /**
-* setupProbeOffsets: create a random list of probe offsets to use when inserting into list
+* bytesUsed: get the size of the filter's blocks
 *
 * returns:
-*   std::vector<size_t>: List of random numbers to use when probing
+*   size_t: bytes of bits the filter holds
 */
-std::vector<size_t> HashTable::setUpProbeOffsets(bool init) {
-    std::vector<size_t> newProbeOffsets;
-    size_t newCapacity = 0;
-
-    //If first time don't multiply capacity by 2
-    if (init) {
-        newCapacity = this->capacity() - 1;
-    }
-    else {
-        newCapacity = (this->capacity() * 2) - 1;
-    }
-
-    //Resize offsets to be new capacity
-    newProbeOffsets.resize(newCapacity, -1);
-
-    //Go through each index of list and insert random number until all numbers in range are found
-    for (size_t i = 0; i < newCapacity;  i++) {
-        while (newProbeOffsets.at(i) == -1) {
-            size_t num = rand() % size_t(newCapacity) + 1;
-            bool found = false;
-
-            //search vector to see if current random number has been used
-            for (size_t j = 0;  j < i; j++) {
-                if (num == newProbeOffsets[j]) {
-                    found = true;
-                    break;
-                }
-            }
+size_t BloomFilter::bytesUsed() const {
+    return this->blocks.size() * sizeof(Block);
+}
 
-            //if not already in use assign random number
-            if (!found) {
-                newProbeOffsets[i] = num;
-            }
-        }
-    }
-    return newProbeOffsets;
-}
\ No newline at end of file
+//The std::string to size_t table is used all over the project, so it is compiled once here
+template class BasicHashTableBucket<std::string_view, size_t>;
+template class BasicHashTable<std::string, size_t>;
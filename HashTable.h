@@ -1,77 +1,3663 @@
+#pragma once
+
+#include "HashFunctions.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <iterator>
 #include <vector>
 #include <optional>
 #include <ostream>
+#include <ranges>
+#include <span>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 /**
  * HashTable.h
+ *
+ * BasicHashTable<Key, Value, Hash, KeyEqual, Allocator> is an open addressing hash table with
+ * pluggable hashing and key comparison. HashTable is the std::string to size_t table the rest of the
+ * project uses. Its keys live in a KeyArena and its lookups take any string_view. Other key types are
+ * stored in the buckets directly, so integer IDs and small structs need no conversion or allocation.
+ * String and integer keys are hashed with a WyHash seeded per table (see HashFunctions.h). Tables
+ * fed keys from untrusted input should pass SipHash as the Hash instead.
+ */
+//One byte so the cache mode reference bit fits next to it without growing the bucket
+enum class BucketType : uint8_t {NORMAL, ESS, EAR};
+
+//Define HASHTABLE_NO_STATS to compile out the probe and resize counters behind HashTable::stats(). Counters
+//that lookups update are relaxed atomics, so const lookups stay safe to run from several threads at once
+#ifdef HASHTABLE_NO_STATS
+inline constexpr bool HASHTABLE_STATS_ENABLED = false;
+#else
+inline constexpr bool HASHTABLE_STATS_ENABLED = true;
+#endif
+
+/**
+ * HashTableStats: snapshot of why a HashTable's lookups are fast or slow. Probe lengths are the
+ * number of buckets looked at, counted in power of two histograms (bucket i holds lengths
+ * 2^i to 2^(i+1) - 1).
+ */
+struct HashTableStats {
+    static constexpr size_t HISTOGRAM_BUCKETS = 16;
+
+    std::array<size_t, HISTOGRAM_BUCKETS> hitProbeLengths{};
+    std::array<size_t, HISTOGRAM_BUCKETS> missProbeLengths{};
+    std::array<size_t, HISTOGRAM_BUCKETS> insertProbeLengths{};
+    size_t maxProbeLength = 0;
+    size_t removedBuckets = 0;
+    size_t resizeCount = 0;
+    size_t inPlaceRehashCount = 0;
+    std::chrono::nanoseconds resizeTime{0};
+    //Lookups the Bloom filter turned away, and ones it let through for keys that were not there
+    size_t bloomRejects = 0;
+    size_t bloomFalsePositives = 0;
+    //Cache mode only: get and contains calls that found their key, ones that did not, and keys evicted to make room.
+    //Inserts are not counted, so a caller that looks a key up and inserts it on a miss counts that miss once
+    size_t cacheHits = 0;
+    size_t cacheMisses = 0;
+    size_t cacheEvictions = 0;
+
+    /**
+    * cacheHitRate: get the share of cache lookups that found their key
+    *
+    * returns:
+    *   double: hits over hits and misses, 0 before any
+    */
+    double cacheHitRate() const {
+        size_t lookups = this->cacheHits + this->cacheMisses;
+        return lookups == 0 ? 0.0 : static_cast<double>(this->cacheHits) / static_cast<double>(lookups);
+    }
+
+    /**
+    * bloomFalsePositiveRate: get the share of lookups for missing keys the Bloom filter let through
+    *
+    * returns:
+    *   double: false positives over all misses the filter saw, 0 before any
+    */
+    double bloomFalsePositiveRate() const {
+        size_t misses = this->bloomRejects + this->bloomFalsePositives;
+        return misses == 0 ? 0.0 : static_cast<double>(this->bloomFalsePositives) / static_cast<double>(misses);
+    }
+
+    /**
+    * recordProbeLength: count one probe sequence in a histogram. Bucket i of the histogram counts
+    *   sequences that looked at between 2^i and 2^(i+1) - 1 buckets, the last bucket takes everything longer.
+    *
+    * param :
+    *   histogram: the histogram to add to
+    *   probes: the number of buckets the probe looked at
+    */
+    static void recordProbeLength(std::array<size_t, HISTOGRAM_BUCKETS>& histogram, size_t probes) {
+        size_t bucket = std::bit_width(std::max<size_t>(probes, 1)) - 1;
+        count(histogram[std::min(bucket, HISTOGRAM_BUCKETS - 1)]);
+    }
+
+    /**
+    * count: add one to a counter that concurrent const lookups may also be adding to
+    *
+    * param :
+    *   counter: the counter to add to
+    */
+    static void count(size_t& counter) {
+        std::atomic_ref<size_t>(counter).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+    * recordMax: raise a counter to a value if it is bigger, safe against concurrent const lookups
+    *
+    * param :
+    *   counter: the running maximum
+    *   value: the value just seen
+    */
+    static void recordMax(size_t& counter, size_t value) {
+        std::atomic_ref<size_t> current(counter);
+        size_t seen = current.load(std::memory_order_relaxed);
+        while (value > seen and !current.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+    * snapshot: copy live counters while const lookups may still be updating them. Not const since
+    *   std::atomic_ref needs a mutable object, tables keep their counters mutable for this.
+    *
+    * returns:
+    *   HashTableStats: a plain copy of the counters
+    */
+    HashTableStats snapshot() {
+        HashTableStats copy = HashTableStats();
+        auto load = [](size_t& counter) { return std::atomic_ref<size_t>(counter).load(std::memory_order_relaxed); };
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            copy.hitProbeLengths[i] = load(this->hitProbeLengths[i]);
+            copy.missProbeLengths[i] = load(this->missProbeLengths[i]);
+            copy.insertProbeLengths[i] = load(this->insertProbeLengths[i]);
+        }
+        copy.maxProbeLength = load(this->maxProbeLength);
+        copy.bloomRejects = load(this->bloomRejects);
+        copy.bloomFalsePositives = load(this->bloomFalsePositives);
+        copy.cacheHits = load(this->cacheHits);
+        copy.cacheMisses = load(this->cacheMisses);
+        //Only changed by operations that modify the table, which never overlap a const call
+        copy.removedBuckets = this->removedBuckets;
+        copy.resizeCount = this->resizeCount;
+        copy.inPlaceRehashCount = this->inPlaceRehashCount;
+        copy.resizeTime = this->resizeTime;
+        copy.cacheEvictions = this->cacheEvictions;
+        return copy;
+    }
+};
+
+/**
+* createOwnerOnlyFile: create or empty a file that only its owner can read or write, before anything
+*   is written to it. A file that already exists has its permissions narrowed too. On Windows the file
+*   keeps the permissions of its directory.
+*
+* param :
+*   path: the file to create
+*
+* returns:
+*   bool: true if the file exists, is empty and is owner only
+*/
+inline bool createOwnerOnlyFile(const std::string& path) {
+#ifdef _WIN32
+    return static_cast<bool>(std::ofstream(path, std::ios::binary | std::ios::trunc));
+#else
+    int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (file < 0) {
+        return false;
+    }
+    bool narrowed = ::fchmod(file, S_IRUSR | S_IWUSR) == 0;
+    return ::close(file) == 0 and narrowed;
+#endif
+}
+
+/**
+* prefetchAddress: ask the CPU to start loading a cache line without waiting for it
+*
+* param :
+*   address: any address in the cache line to load
+*/
+inline void prefetchAddress(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+/**
+ * KeyArena: owns the bytes of every key in a HashTable. Keys are copied back to back into large
+ * slabs so inserting a key does not allocate, and the whole arena is freed a slab at a time.
+ * Stored keys never move until the arena is cleared. Slabs come from a std::pmr::memory_resource,
+ * the table's when it has a polymorphic allocator, and each slab remembers which resource to give
+ * it back to so slabs can be handed between arenas.
+ */
+class KeyArena {
+    private:
+        struct Slab {
+            char* bytes;
+            size_t size;
+            std::pmr::memory_resource* resource;
+        };
+
+        std::vector<Slab> slabs;
+        std::pmr::memory_resource* resource;
+        char* cursor;
+        size_t remaining;
+        size_t usedBytes;
+
+        char* allocateSlab(size_t bytes);
+
+    public:
+        static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+        explicit KeyArena(std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
+        ~KeyArena();
+        KeyArena(KeyArena&& other) noexcept;
+        KeyArena& operator=(KeyArena&& other) noexcept;
+        KeyArena(const KeyArena&) = delete;
+        KeyArena& operator=(const KeyArena&) = delete;
+        std::string_view store(std::string_view key);
+        char* allocateBlock(size_t bytes);
+        void merge(KeyArena&& other);
+        void clear();
+        size_t bytesUsed() const;
+};
+
+/**
+* memoryResourceOf: get the memory resource behind an allocator, for the parts of a table that do
+*   not allocate through it. Allocators other than std::pmr::polymorphic_allocator get the global heap.
+*
+* param :
+*   allocator: the table's allocator
+*
+* returns:
+*   std::pmr::memory_resource*: the allocator's resource, or std::pmr::new_delete_resource()
+*/
+template <typename Allocator>
+std::pmr::memory_resource* memoryResourceOf(const Allocator& allocator) {
+    if constexpr (requires { { allocator.resource() } -> std::convertible_to<std::pmr::memory_resource*>; }) {
+        return allocator.resource();
+    }
+    else {
+        return std::pmr::new_delete_resource();
+    }
+}
+
+/**
+ * BloomFilter: split block Bloom filter over key hashes. Each key picks one 64 byte block and sets
+ * one bit in each of the block's eight words, so adding or checking a key reads a single cache line.
+ * With BITS_PER_KEY bits per key about 0.1% of missing keys get through. Bits cannot be taken out,
+ * so the owner rebuilds the filter once removed keys add up. Hashes should be well mixed in all 64 bits.
+ */
+class BloomFilter {
+    private:
+        struct alignas(64) Block {
+            uint64_t words[8];
+        };
+
+        static constexpr uint32_t SALTS[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+        std::pmr::vector<Block> blocks;
+        size_t keyCapacity;
+
+        const Block& blockFor(uint64_t hashValue) const;
+
+    public:
+        static constexpr size_t BITS_PER_KEY = 16;
+
+        explicit BloomFilter(std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
+        void reset(size_t keyCount);
+        void clear();
+        void add(uint64_t hashValue);
+        void addShared(uint64_t hashValue);
+        bool mayContain(uint64_t hashValue) const;
+        void prefetch(uint64_t hashValue) const;
+        size_t capacity() const;
+        size_t bytesUsed() const;
+};
+
+/**
+* blockFor: get the block a hash maps to, from the top half of the hash
+*/
+inline auto BloomFilter::blockFor(uint64_t hashValue) const -> const Block& {
+    return this->blocks[static_cast<size_t>(((hashValue >> 32) * this->blocks.size()) >> 32)];
+}
+
+/**
+* mayContain: check if a key could have been added. Never false for a key that was added.
+*
+* param :
+*   hashValue: the key's hash
+*
+* returns:
+*   bool: false if the key was surely never added
+*/
+inline bool BloomFilter::mayContain(uint64_t hashValue) const {
+    if (this->blocks.empty()) {
+        return true;
+    }
+    const Block& block = this->blockFor(hashValue);
+    uint32_t low = static_cast<uint32_t>(hashValue);
+    bool present = true;
+    for (size_t i = 0; i < 8; i++) {
+        present &= ((block.words[i] >> ((low * SALTS[i]) >> 26)) & 1) != 0;
+    }
+    return present;
+}
+
+/**
+* prefetch: start loading the block a hash maps to
+*
+* param :
+*   hashValue: the hash of the key about to be checked
+*/
+inline void BloomFilter::prefetch(uint64_t hashValue) const {
+    if (!this->blocks.empty()) {
+        prefetchAddress(&this->blockFor(hashValue));
+    }
+}
+
+/**
+* add: set a key's bits
+*
+* param :
+*   hashValue: the key's hash
+*/
+inline void BloomFilter::add(uint64_t hashValue) {
+    if (this->blocks.empty()) {
+        return;
+    }
+    Block& block = const_cast<Block&>(this->blockFor(hashValue));
+    uint32_t low = static_cast<uint32_t>(hashValue);
+    for (size_t i = 0; i < 8; i++) {
+        block.words[i] |= uint64_t(1) << ((low * SALTS[i]) >> 26);
+    }
+}
+
+/**
+ * KeyStorage: how a BasicHashTable keeps its keys. By default a key is copied into its bucket and
+ * looked up by const reference, so there is no arena and nothing to restore when buckets move.
+ */
+template <typename Key>
+struct KeyStorage {
+    using Stored = Key;
+    using View = const Key&;
+    //Integers get the seeded WyHash, other keys need a std::hash or a Hash passed to the table
+    using DefaultHash = std::conditional_t<std::is_integral_v<Key>, WyHash, std::hash<Key>>;
+    static constexpr bool USES_ARENA = false;
+
+    //Buckets hold the key itself, so storing one just hands it back
+    struct Arena {
+        explicit Arena(std::pmr::memory_resource* = nullptr) {}
+        const Key& store(const Key& key) { return key; }
+        void merge(Arena&&) {}
+        void clear() {}
+        size_t bytesUsed() const { return 0; }
+    };
+
+    static size_t keyBytes(const Key&) { return 0; }
+};
+
+/**
+ * KeyStorage<std::string>: string keys are copied into the table's KeyArena and buckets only hold a
+ * string_view of them. Lookups take a string_view, so a custom Hash for string keys has to accept one.
+ */
+template <>
+struct KeyStorage<std::string> {
+    using Stored = std::string_view;
+    using View = std::string_view;
+    using DefaultHash = WyHash;
+    static constexpr bool USES_ARENA = true;
+    using Arena = KeyArena;
+
+    static size_t keyBytes(std::string_view key) { return key.size(); }
+};
+
+/**
+ * Snapshottable: a table can be saved to and loaded from a snapshot file when its values and hash
+ * function are plain bytes, and its keys are either plain bytes or arena backed strings.
+ */
+template <typename Key, typename Value, typename Hash>
+concept Snapshottable = std::is_trivially_copyable_v<Value> and std::is_trivially_copyable_v<Hash> and
+                        (KeyStorage<Key>::USES_ARENA or std::is_trivially_copyable_v<Key>);
+
+/**
+ * PairRangeOf: a sized random access range of pairs whose first converts to a table's KeyView and
+ * whose second converts to its Value, what bulkLoad takes.
  */
-enum class BucketType {NORMAL, ESS, EAR};
+template <typename Range, typename KeyView, typename Value>
+concept PairRangeOf = std::ranges::random_access_range<Range> and std::ranges::sized_range<Range> and
+                      requires(std::ranges::range_reference_t<Range> pair) {
+                          { pair.first } -> std::convertible_to<KeyView>;
+                          { pair.second } -> std::convertible_to<Value>;
+                      };
 
-class HashTableBucket{
+template <typename Stored, typename Value>
+class BasicHashTableBucket{
     private:
     mutable BucketType type;
-        std::string key;
-        size_t value;
+        //Cache mode: set when the key is used, cleared as the CLOCK hand passes, the key is evicted if still clear
+        mutable bool referenced;
+        //Robin Hood mode: how many buckets past its home bucket the key sits. Cuckoo mode: the top half
+        //of the key's hash, so most buckets can be passed over without reading their key
+        uint32_t distance;
+        Stored key;
+        Value value;
 
     public:
-        HashTableBucket();
-        HashTableBucket(std::string key, int value);
-        void load(std::string key, int value);
+        BasicHashTableBucket();
+        BasicHashTableBucket(Stored key, Value value);
+        void load(Stored key, Value value);
         bool isEmpty() const;
         bool isEmptySinceStart() const;
         void setBucketType(BucketType type) const;
-        std::string getKey() const;
-        size_t& getValueRef();
-        size_t getValue() const;
+        const Stored& getKey() const;
+        Value& getValueRef();
+        const Value& getValueRef() const;
+        Value getValue() const;
+        uint32_t getDistance() const;
+        void setDistance(uint32_t distance);
+        bool isReferenced() const;
+        void markReferenced() const;
+        void setReferenced(bool referenced) const;
 };
 
 
-class HashTable {
+/**
+ * BasicHashTable: Key and Value must be default constructible since empty buckets hold them too.
+ * Hash is called with a KeyView, and KeyEqual compares a stored key with a KeyView.
+ */
+template <typename Key, typename Value, typename Hash = typename KeyStorage<Key>::DefaultHash,
+          typename KeyEqual = std::equal_to<>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class BasicHashTable {
+    public:
+        //What lookups take: std::string_view for string keys, const Key& for everything else
+        using KeyView = typename KeyStorage<Key>::View;
+        using KeyValue = std::remove_cvref_t<KeyView>;
+
     private:
-        std::vector<HashTableBucket> tableData;
-        std::vector<size_t> probeOffsets;
+        using Storage = KeyStorage<Key>;
+        using Bucket = BasicHashTableBucket<typename Storage::Stored, Value>;
+        using BucketAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket>;
+        using BucketVector = std::vector<Bucket, BucketAllocator>;
+
+        static constexpr size_t MIGRATE_BUCKETS_PER_OP = 16;
+        //Fewer buckets than this per thread and starting threads costs more than it saves
+        static constexpr size_t PARALLEL_BUCKETS_PER_THREAD = 16 * 1024;
+        //Cuckoo mode keeps each key in one of two sets of CUCKOO_SET_SIZE buckets, or in the stash made of
+        //the last CUCKOO_STASH_SIZE (plus any leftover) buckets. An insert gives up on kicking keys
+        //between sets after CUCKOO_MAX_KICKS and puts the key left over in the stash
+        static constexpr size_t CUCKOO_SET_SIZE = 4;
+        static constexpr size_t CUCKOO_STASH_SIZE = 8;
+        static constexpr size_t CUCKOO_MAX_KICKS = 500;
+        //bulkLoad tags each bucket with the thread that claimed it, 0 is free and this is a bucket filled before the load
+        static constexpr uint8_t BULK_FILLED = 255;
+
+        //Snapshot files start with this header, see save() for the layout that follows
+        struct SnapshotHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint32_t keyBytes;
+            uint32_t valueBytes;
+            uint32_t hashBytes;
+            //0 for double hashing, 1 for Robin Hood, 2 for cuckoo
+            uint32_t probing;
+            uint64_t size;
+            uint64_t removed;
+            uint64_t probeSeed;
+            uint64_t removedKeyBytes;
+            uint64_t migrateIndex;
+            uint64_t migrateStep;
+            uint64_t tableCount;
+            double maxLoadFactor;
+            double growthFactor;
+        };
+
+        static constexpr char SNAPSHOT_MAGIC[8] = {'H', 'T', 'S', 'N', 'A', 'P', '\0', '\0'};
+        static constexpr uint32_t SNAPSHOT_VERSION = 2;
+        static constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+        static constexpr size_t SNAPSHOT_CHUNK = 64 * 1024;
+
+        BucketVector tableData;
+        BucketVector oldTableData;
+        typename Storage::Arena keyArena;
+        typename Storage::Arena oldKeyArena;
+        size_t removedKeyBytes;
         size_t numCapacity;
         size_t numSize;
+        size_t numRemoved;
+        size_t probeSeed;
+        size_t migrateIndex;
+        size_t migrateStep;
+        bool incrementalResize;
+        size_t rehashThreads;
+        bool robinHood;
+        bool cuckoo;
+        //With the Bloom filter on, bloom holds every key in either vector table and nextBloom is filled
+        //with the keys of the current one during a migration. bloomStale counts removes since the last build
+        bool bloomFilter;
+        BloomFilter bloom;
+        BloomFilter nextBloom;
+        size_t bloomStale;
+        //Cache mode holds at most cacheEntries keys, 0 when off, and clockHand is the next bucket to check for eviction
+        size_t cacheEntries;
+        size_t clockHand;
+        double maxLoadFactor;
+        double growthFactor;
+        mutable HashTableStats counters;
+        [[no_unique_address]] Hash hasher;
+        [[no_unique_address]] KeyEqual keyEqual;
+
+        std::optional<size_t> findIndex(const BucketVector& table, KeyView key, size_t hashValue, size_t& probes) const;
+        const Bucket* findBucket(KeyView key, size_t hashValue) const;
+        Bucket* findBucket(KeyView key, size_t hashValue);
+        const Bucket* findBucket(KeyView key) const;
+        Bucket* findBucket(KeyView key);
+        size_t placeBucket(BucketVector& table, KeyView key, size_t hashValue, Value value, size_t& probes);
+        size_t placeRobinHood(BucketVector& table, KeyView key, size_t hashValue, Value value, size_t& probes);
+        void shiftBackFrom(size_t index);
+        std::optional<size_t> placeCuckoo(BucketVector& table, Bucket& carried, size_t hashValue, size_t& probes);
+        std::pair<size_t, size_t> cuckooSets(size_t hashValue, size_t tableCapacity) const;
+        static uint32_t cuckooTag(size_t hashValue);
+        void removeCuckoo(size_t index);
+        size_t grownCapacity() const;
+        void bloomAdd(size_t hashValue);
+        void rebuildBloom();
+        void rebuildBloomIfFull();
+        size_t bloomKeyCount() const;
+        void eraseBucket(Bucket* bucket);
+        void evictOne();
+        void recordCacheAccess(const Bucket* bucket) const;
+        std::pair<Value&, bool> tryEmplaceHashed(KeyView key, size_t hashValue, Value value);
+        void prefetchHome(size_t hashValue) const;
+        void prefetchHomeKey(size_t hashValue) const;
+        template <typename KeyAt, typename Resolve>
+        void batchProbe(size_t count, KeyAt&& keyAt, Resolve&& resolve) const;
+        void restoreKeys();
+        size_t homeIndex(size_t hashValue, size_t tableCapacity) const;
+        size_t probeStep(size_t hashValue, size_t tableCapacity) const;
+        size_t fitCapacity(size_t capacity) const;
+        size_t seededMix(size_t hashValue) const;
+        size_t parallelThreadCount(size_t work) const;
+        template <typename Work>
+        static void runParallel(size_t threadCount, size_t count, Work&& work);
+        template <typename EntryAt>
+        void placeParallel(size_t count, EntryAt&& entryAt, size_t threadCount);
+        void sortRobinHoodClusters(const std::vector<size_t>& homes, size_t threadCount);
+        std::vector<typename Storage::Arena> threadArenas(size_t threadCount) const;
+        template <typename Range>
+        size_t bulkLoadParallel(const Range& pairs, size_t threadCount);
+        void rehash(size_t newCapacity);
+        void startMigration(size_t newCapacity);
+        void migrateBuckets(size_t count);
+        size_t capacityFor(size_t count) const;
+        void compactIfNeeded();
+        bool compactsByMigrating() const;
+        void startCompaction();
+        void rehashInPlace();
+        bool writeTable(std::ostream& out, const BucketVector& table) const;
+        bool readTable(std::istream& in, BucketVector& table, typename Storage::Arena& arena, size_t& filled);
+        void copySettings(const BasicHashTable& other);
 
     public:
-        explicit HashTable(size_t initCapacity = 8);
-        bool insert(std::string key, size_t value);
-        bool remove(std::string key);
-        bool contains(const std::string& key) const;
-        std::optional<int> get(const std::string& key) const;
+        template <bool IsConst>
+        class Iterator;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+        static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.5;
+        static constexpr double DEFAULT_GROWTH_FACTOR = 2.0;
+        static constexpr size_t BATCH_WINDOW = 16;
+
+        explicit BasicHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY, const Hash& hashFunction = Hash(),
+                                const KeyEqual& keyEquals = KeyEqual(), const Allocator& allocator = Allocator());
+        template <PairRangeOf<typename KeyStorage<Key>::View, Value> Range>
+        explicit BasicHashTable(Range&& pairs, const Hash& hashFunction = Hash(), const KeyEqual& keyEquals = KeyEqual(),
+                                const Allocator& allocator = Allocator());
+        BasicHashTable(const BasicHashTable& other);
+        BasicHashTable(BasicHashTable&& other) noexcept = default;
+        BasicHashTable& operator=(const BasicHashTable& other);
+        BasicHashTable& operator=(BasicHashTable&& other);
+        bool insert(KeyView key, Value value);
+        std::pair<Value&, bool> try_emplace(KeyView key, Value value);
+        bool insert_or_assign(KeyView key, Value value);
+        bool remove(KeyView key);
+        bool contains(KeyView key) const;
+        std::optional<Value> get(KeyView key) const;
+        bool insertHashed(KeyView key, size_t hashValue, Value value);
+        bool insertOrAssignHashed(KeyView key, size_t hashValue, Value value);
+        bool removeHashed(KeyView key, size_t hashValue);
+        bool containsHashed(KeyView key, size_t hashValue) const;
+        std::optional<Value> getHashed(KeyView key, size_t hashValue) const;
+        size_t getBatch(std::span<const KeyValue> keys, std::span<std::optional<Value>> results) const;
+        size_t containsBatch(std::span<const KeyValue> keys, std::span<bool> results) const;
+        size_t insertBatch(std::span<const std::pair<KeyValue, Value>> pairs);
+        template <PairRangeOf<typename KeyStorage<Key>::View, Value> Range>
+        size_t bulkLoad(Range&& pairs);
         size_t capacity() const;
-        size_t& operator[](const std::string& key);
-        std::vector<std::string> keys() const;
+        Value& operator[](KeyView key);
+        std::vector<Key> keys() const;
         double alpha() const;
         size_t size() const;
-        size_t hash(std::string key) const;
-        std::optional<int> getIndex(const std::string& key) const;
-        std::vector<size_t> setUpProbeOffsets(bool init);
+        size_t removedCount() const;
+        HashTableStats stats() const;
+        void resetStats();
+        size_t hash(KeyView key) const;
+        std::optional<int> getIndex(KeyView key) const;
+        void reserve(size_t count);
+        void shrink_to_fit();
+        bool setMaxLoadFactor(double loadFactor);
+        double getMaxLoadFactor() const;
+        bool setGrowthFactor(double factor);
+        double getGrowthFactor() const;
+        void setIncrementalResize(bool enabled);
+        void setRehashThreads(size_t threads);
+        size_t getRehashThreads() const;
+        bool isResizing() const;
+        void setRobinHood(bool enabled);
+        bool isRobinHood() const;
+        void setCuckoo(bool enabled);
+        bool isCuckoo() const;
+        void setBloomFilter(bool enabled);
+        bool hasBloomFilter() const;
+        size_t bloomFilterBytes() const;
+        void setCacheCapacity(size_t entries);
+        size_t getCacheCapacity() const;
+        Allocator get_allocator() const;
+        bool save(const std::string& path) const requires Snapshottable<Key, Value, Hash>;
+        bool load(const std::string& path) requires Snapshottable<Key, Value, Hash>;
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator cbegin() const;
+        const_iterator cend() const;
+};
 
-    /**
-     *
-     * << operator: this operator prints to stream the filled buckets of the hashTable
-     *      Format of each bucket is: Bucket (index): <key, value>
-     *
-     *      paramaters:
-     *          os: refrence to output stream used
-     *          hashTable: reference to the hashTable that shall be used
-     *
-    */
-    friend std::ostream& operator<<(std::ostream& os, const HashTable& hashTable) {
-        //Get list of filled buckets
-        std::vector<std::string> curKeyList = hashTable.keys();
+using HashTable = BasicHashTable<std::string, size_t>;
+
+//Tables whose buckets and keys all come from one std::pmr::memory_resource, passed in as the allocator
+template <typename Key, typename Value, typename Hash = typename KeyStorage<Key>::DefaultHash, typename KeyEqual = std::equal_to<>>
+using BasicPmrHashTable = BasicHashTable<Key, Value, Hash, KeyEqual, std::pmr::polymorphic_allocator<std::pair<const Key, Value>>>;
+using PmrHashTable = BasicPmrHashTable<std::string, size_t>;
+using HashTableBucket = BasicHashTableBucket<std::string_view, size_t>;
 
-        //For each filled bucket get its key, index and value
-        for (size_t i = 0; i < curKeyList.size(); i++) {
-            std::string curKey = curKeyList[i];
-            size_t curIndex = hashTable.getIndex(curKey).value();
-            size_t curValue = hashTable.get(curKey).value();
+/**
+ * HashTable::Iterator: forward iterator over the filled buckets of a HashTable. Dereferencing gives a
+ * (key, value) pair that references the bucket directly, so walking the table never allocates or
+ * re-probes. While an incremental resize is running the old table's buckets are visited after the
+ * current table's. Inserting or removing keys invalidates iterators.
+ */
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <bool IsConst>
+class BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::Iterator {
+    private:
+        using Element = std::conditional_t<IsConst, const Bucket, Bucket>;
+
+        Element* bucket;
+        Element* tableBegin;
+        Element* tableEnd;
+        Element* oldBegin;
+        Element* oldEnd;
+        bool inOld;
 
-            //Output values to stream
-            os << "Bucket " << curIndex << ": <" << curKey << ", " << curValue << ">" << std::endl;
+        /**
+        * skipEmpty: move forward until the iterator is on a filled bucket or at the end, switching over
+        *   to the old table when the current one runs out
+        */
+        void skipEmpty() {
+            while (true) {
+                while (this->bucket != this->tableEnd and this->bucket->isEmpty()) {
+                    ++this->bucket;
+                }
+                if (this->bucket != this->tableEnd or this->oldBegin == this->oldEnd) {
+                    return;
+                }
+                this->tableBegin = this->bucket = this->oldBegin;
+                this->tableEnd = this->oldEnd;
+                this->oldBegin = this->oldEnd = nullptr;
+                this->inOld = true;
+            }
         }
 
-        return os;
-    }
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::pair<KeyValue, Value>;
+        using reference = std::pair<KeyView, std::conditional_t<IsConst, const Value&, Value&>>;
+
+        struct pointer {
+            reference ref;
+            reference* operator->() { return &this->ref; }
+        };
+
+        Iterator() : Iterator(nullptr) {}
+
+        /**
+        * Iterator end constructor: Makes the past the end iterator, which only needs to compare equal
+        *
+        * param :
+        *   endBucket: one past the last bucket of the last vector table
+        */
+        explicit Iterator(Element* endBucket)
+            : bucket(endBucket), tableBegin(nullptr), tableEnd(nullptr), oldBegin(nullptr), oldEnd(nullptr), inOld(false) {}
+
+        /**
+        * Iterator constructor: Starts at a bucket of the current table and skips to the first filled one
+        *
+        * param :
+        *   start: the bucket to start at
+        *   table: the current vector table
+        *   oldTable: the old vector table, empty unless an incremental resize is running
+        */
+        template <typename Table>
+        Iterator(Element* start, Table& table, Table& oldTable)
+            : bucket(start), tableBegin(table.data()), tableEnd(table.data() + table.size()),
+              oldBegin(oldTable.data()), oldEnd(oldTable.data() + oldTable.size()), inOld(false) {
+            this->skipEmpty();
+        }
+
+        //A non-const iterator can always be used where a const one is expected
+        operator Iterator<true>() const {
+            Iterator<true> result;
+            result.bucket = this->bucket;
+            result.tableBegin = this->tableBegin;
+            result.tableEnd = this->tableEnd;
+            result.oldBegin = this->oldBegin;
+            result.oldEnd = this->oldEnd;
+            result.inOld = this->inOld;
+            return result;
+        }
+
+        reference operator*() const {
+            return {this->bucket->getKey(), this->bucket->getValueRef()};
+        }
+
+        pointer operator->() const {
+            return {**this};
+        }
+
+        Iterator& operator++() {
+            ++this->bucket;
+            this->skipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return this->bucket == other.bucket;
+        }
+
+        /**
+        * bucketIndex: get the index of the bucket the iterator is on within its vector table
+        *
+        * returns:
+        *   size_t: Index of the current bucket
+        */
+        size_t bucketIndex() const {
+            return static_cast<size_t>(this->bucket - this->tableBegin);
+        }
+
+        /**
+        * inOldTable: check if the iterator has moved on to the old table of an incremental resize
+        *
+        * returns:
+        *   bool: true if the current bucket is in the old table
+        */
+        bool inOldTable() const {
+            return this->inOld;
+        }
+
+        friend class Iterator<!IsConst>;
 };
+
+/**
+ *
+ * << operator: this operator prints to stream the filled buckets of the hashTable
+ *      Format of each bucket is: Bucket (index): <key, value>
+ *
+ *      paramaters:
+ *          os: refrence to output stream used
+ *          hashTable: reference to the hashTable that shall be used
+ *
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::ostream& operator<<(std::ostream& os, const BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>& hashTable) {
+    //For each filled bucket print its index, key and value in one pass over the buckets
+    for (auto it = hashTable.begin(); it != hashTable.end(); ++it) {
+        //Keys that have not migrated yet during an incremental resize are still in the old table
+        os << (it.inOldTable() ? "Old bucket " : "Bucket ") << it.bucketIndex()
+           << ": <" << it->first << ", " << it->second << ">" << std::endl;
+    }
+
+    return os;
+}
+
+/**
+*  HashTableBucket default constructor: Sets the bucket created to empty since start
+*/
+template <typename Stored, typename Value>
+BasicHashTableBucket<Stored, Value>::BasicHashTableBucket() {
+    this->setBucketType(BucketType::ESS);
+    this->referenced = false;
+    this->distance = 0;
+}
+/**
+* HashTableBucket parameterized constructor: Initialize the key and value
+* and set bucketType to normal via load method
+*
+* params:
+*   key: the key you want to insert into the bucket
+*   value: the value that should be in the bucket
+*/
+template <typename Stored, typename Value>
+BasicHashTableBucket<Stored, Value>::BasicHashTableBucket(Stored key, Value value) {
+    this->load(std::move(key), std::move(value));
+    this->distance = 0;
+}
+
+/**
+* Load: load the given key and value into the bucket's fields. The bucket only references the key,
+* its bytes belong to the table's KeyArena.
+*
+* params:
+*   key: the key you want to have in the bucket
+*   value: the value that should be in the bucket
+*/
+template <typename Stored, typename Value>
+void BasicHashTableBucket<Stored, Value>::load(Stored key, Value value) {
+    this->setBucketType(BucketType::NORMAL);
+    this->referenced = false;
+    this->key = std::move(key);
+    this->value = std::move(value);
+}
+
+/**
+* isEmpty: checks the bucket type to see if it is empty or not
+*
+* return :
+*   bool is the bucket not of type empty since start or empty after remove
+*/
+template <typename Stored, typename Value>
+bool BasicHashTableBucket<Stored, Value>::isEmpty() const {
+    if ((this->type == BucketType::ESS) or (this->type == BucketType::EAR)){
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+* isEmptySinceStart: checks the bucket type to see if it is emptySinceStart
+*
+* return :
+*   bool is the bucket not of type empty since start
+*/
+template <typename Stored, typename Value>
+bool BasicHashTableBucket<Stored, Value>::isEmptySinceStart() const {
+    if (this->type == BucketType::ESS){
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+* setBucketType: sets the bucket type
+*
+* param :
+*   BucketType: is the bucket type you are going to set the bucket to
+*/
+template <typename Stored, typename Value>
+void BasicHashTableBucket<Stored, Value>::setBucketType(BucketType type) const{
+    this->type = type;
+}
+
+/**
+* getKey: gets value of the key field
+*
+* return :
+*   const Stored&: is the buckets key field
+*/
+template <typename Stored, typename Value>
+const Stored& BasicHashTableBucket<Stored, Value>::getKey() const{
+    return this->key;
+}
+
+/**
+* getValueRef: gets reference to the value field
+*
+* return :
+*   Value&: is the buckets value field reference
+*/
+template <typename Stored, typename Value>
+Value& BasicHashTableBucket<Stored, Value>::getValueRef(){
+    return this->value;
+}
+
+/**
+* getValueRef: gets const reference to the value field
+*
+* return :
+*   const Value&: is the buckets value field reference
+*/
+template <typename Stored, typename Value>
+const Value& BasicHashTableBucket<Stored, Value>::getValueRef() const{
+    return this->value;
+}
+
+/**
+* getValue: gets value of the value field
+*
+* return :
+*   Value: is the buckets value field value
+*/
+template <typename Stored, typename Value>
+Value BasicHashTableBucket<Stored, Value>::getValue() const{
+    return this->value;
+}
+
+/**
+* getDistance: gets how far the bucket is from its key's home bucket, only kept in Robin Hood mode
+*
+* return :
+*   uint32_t: number of buckets between the key's home bucket and this one
+*/
+template <typename Stored, typename Value>
+uint32_t BasicHashTableBucket<Stored, Value>::getDistance() const{
+    return this->distance;
+}
+
+/**
+* setDistance: sets how far the bucket is from its key's home bucket
+*
+* params:
+*   distance: number of buckets between the key's home bucket and this one
+*/
+template <typename Stored, typename Value>
+void BasicHashTableBucket<Stored, Value>::setDistance(uint32_t distance) {
+    this->distance = distance;
+}
+
+/**
+* isReferenced: check if the key was used since the CLOCK hand last passed the bucket
+*
+* returns:
+*   bool: the bucket's reference bit
+*/
+template <typename Stored, typename Value>
+bool BasicHashTableBucket<Stored, Value>::isReferenced() const {
+    return std::atomic_ref<bool>(this->referenced).load(std::memory_order_relaxed);
+}
+
+/**
+* markReferenced: set the reference bit for a key that was just used. Const lookups call this, so the bit
+*   is a relaxed atomic and several readers can mark the same bucket at once. The store is skipped when
+*   the bit is already set so the lines of hot buckets are not written on every hit.
+*/
+template <typename Stored, typename Value>
+void BasicHashTableBucket<Stored, Value>::markReferenced() const {
+    std::atomic_ref<bool> bit(this->referenced);
+    if (!bit.load(std::memory_order_relaxed)) {
+        bit.store(true, std::memory_order_relaxed);
+    }
+}
+
+/**
+* setReferenced: set or clear the reference bit
+*
+* params:
+*   referenced: the new reference bit
+*/
+template <typename Stored, typename Value>
+void BasicHashTableBucket<Stored, Value>::setReferenced(bool referenced) const {
+    std::atomic_ref<bool>(this->referenced).store(referenced, std::memory_order_relaxed);
+}
+
+
+/**
+* BasicHashTable constructor: Takes a capacity and initializes the size, capacity values. Also initalizes the
+*   tableData vector and picks the seed used to build each key's probe sequence.
+*
+* param :
+*   initCapacity: defaults to 8 but is the base HashTable capacity otherwise
+*   hashFunction: the hash function, called with a KeyView
+*   keyEquals: compares a stored key with a KeyView
+*   allocator: allocates the bucket vectors
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::BasicHashTable(size_t initCapacity, const Hash& hashFunction, const KeyEqual& keyEquals,
+                                                              const Allocator& allocator)
+    : tableData(BucketAllocator(allocator)), oldTableData(BucketAllocator(allocator)), keyArena(memoryResourceOf(allocator)),
+      oldKeyArena(memoryResourceOf(allocator)), bloom(memoryResourceOf(allocator)), nextBloom(memoryResourceOf(allocator)),
+      hasher(hashFunction), keyEqual(keyEquals) {
+    //New tables use double hashing, which needs a power of two
+    this->numCapacity = std::bit_ceil(std::max<size_t>(initCapacity, 1));
+    this->numSize = 0;
+    this->probeSeed = randomSeed();
+    this->incrementalResize = false;
+    this->robinHood = false;
+    this->cuckoo = false;
+    this->bloomFilter = false;
+    this->bloomStale = 0;
+    this->cacheEntries = 0;
+    this->clockHand = 0;
+    this->rehashThreads = 0;
+    this->migrateIndex = 0;
+    this->migrateStep = MIGRATE_BUCKETS_PER_OP;
+    this->removedKeyBytes = 0;
+    this->numRemoved = 0;
+    this->maxLoadFactor = DEFAULT_MAX_LOAD_FACTOR;
+    this->growthFactor = DEFAULT_GROWTH_FACTOR;
+    tableData.resize(this->numCapacity);
+}
+
+/**
+* BasicHashTable range constructor: Makes a table holding the given pairs, built with bulkLoad
+*
+* param :
+*   pairs: the key-value pairs to start with, the first of two equal keys wins
+*   hashFunction: the Hash to hash keys with
+*   keyEquals: the KeyEqual to compare keys with
+*   allocator: the Allocator the buckets come from
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <PairRangeOf<typename KeyStorage<Key>::View, Value> Range>
+BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::BasicHashTable(Range&& pairs, const Hash& hashFunction, const KeyEqual& keyEquals,
+                                                              const Allocator& allocator)
+    : BasicHashTable(DEFAULT_INITIAL_CAPACITY, hashFunction, keyEquals, allocator) {
+    this->bulkLoad(pairs);
+}
+
+/**
+* BasicHashTable copy constructor: Copies the buckets of another table. Buckets only reference keys in
+*   the other table's arena, so every key is stored again in this table's own arena.
+*
+* param :
+*   other: the table to copy
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::BasicHashTable(const BasicHashTable& other)
+    : tableData(other.tableData), oldTableData(other.oldTableData), keyArena(memoryResourceOf(this->tableData.get_allocator())),
+      oldKeyArena(memoryResourceOf(this->tableData.get_allocator())), bloom(memoryResourceOf(this->tableData.get_allocator())),
+      nextBloom(memoryResourceOf(this->tableData.get_allocator())), hasher(other.hasher), keyEqual(other.keyEqual) {
+    this->copySettings(other);
+    this->removedKeyBytes = 0;
+    this->restoreKeys();
+}
+
+/**
+* copySettings: copy everything but the buckets, arenas and functors from another table. Bloom filter
+*   blocks are copied into this table's own resource.
+*
+* param :
+*   other: the table to copy from
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::copySettings(const BasicHashTable& other) {
+    this->numCapacity = other.numCapacity;
+    this->numSize = other.numSize;
+    this->numRemoved = other.numRemoved;
+    this->probeSeed = other.probeSeed;
+    this->migrateIndex = other.migrateIndex;
+    this->migrateStep = other.migrateStep;
+    this->incrementalResize = other.incrementalResize;
+    this->robinHood = other.robinHood;
+    this->cuckoo = other.cuckoo;
+    this->bloomFilter = other.bloomFilter;
+    this->bloom = other.bloom;
+    this->nextBloom = other.nextBloom;
+    this->bloomStale = other.bloomStale;
+    this->cacheEntries = other.cacheEntries;
+    this->clockHand = other.clockHand;
+    this->rehashThreads = other.rehashThreads;
+    this->maxLoadFactor = other.maxLoadFactor;
+    this->growthFactor = other.growthFactor;
+    this->counters = other.counters.snapshot();
+}
+
+/**
+* BasicHashTable copy assignment: Copies the buckets of another table into this table's own bucket
+*   vectors and stores every key again in a fresh arena, so this table keeps its allocator and all of
+*   its memory keeps coming from its own resource, as std::pmr containers do.
+*
+* param :
+*   other: the table to copy
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>& BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::operator=(const BasicHashTable& other) {
+    if (this == &other) {
+        return *this;
+    }
+    this->tableData = other.tableData;
+    this->oldTableData = other.oldTableData;
+    this->keyArena.clear();
+    this->oldKeyArena.clear();
+    this->hasher = other.hasher;
+    this->keyEqual = other.keyEqual;
+    this->copySettings(other);
+    this->removedKeyBytes = 0;
+    this->restoreKeys();
+    return *this;
+}
+
+/**
+* BasicHashTable move assignment: Takes over the buckets and key slabs of another table when both
+*   allocate from the same place. Otherwise the slabs would end up owned by the wrong resource, so the
+*   table is copied instead, which can throw std::bad_alloc like any copy.
+*
+* param :
+*   other: the table to take the contents of
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>& BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::operator=(BasicHashTable&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (this->tableData.get_allocator() != other.tableData.get_allocator()) {
+        return *this = std::as_const(other);
+    }
+    this->tableData = std::move(other.tableData);
+    this->oldTableData = std::move(other.oldTableData);
+    std::swap(this->keyArena, other.keyArena);
+    std::swap(this->oldKeyArena, other.oldKeyArena);
+    std::swap(this->removedKeyBytes, other.removedKeyBytes);
+    std::swap(this->numCapacity, other.numCapacity);
+    std::swap(this->numSize, other.numSize);
+    std::swap(this->numRemoved, other.numRemoved);
+    std::swap(this->probeSeed, other.probeSeed);
+    std::swap(this->migrateIndex, other.migrateIndex);
+    std::swap(this->migrateStep, other.migrateStep);
+    std::swap(this->incrementalResize, other.incrementalResize);
+    std::swap(this->robinHood, other.robinHood);
+    std::swap(this->cuckoo, other.cuckoo);
+    std::swap(this->bloomFilter, other.bloomFilter);
+    this->bloom = std::move(other.bloom);
+    this->nextBloom = std::move(other.nextBloom);
+    std::swap(this->bloomStale, other.bloomStale);
+    std::swap(this->cacheEntries, other.cacheEntries);
+    std::swap(this->clockHand, other.clockHand);
+    std::swap(this->rehashThreads, other.rehashThreads);
+    std::swap(this->maxLoadFactor, other.maxLoadFactor);
+    std::swap(this->growthFactor, other.growthFactor);
+    std::swap(this->counters, other.counters);
+    std::swap(this->hasher, other.hasher);
+    std::swap(this->keyEqual, other.keyEqual);
+    return *this;
+}
+
+/**
+* insert: Inserts a new key-value pair into the hashTable. If the key is already in the table
+*   than it is not inserted. For string keys any string, string_view or C string can be passed as
+*   the key, only its bytes are copied into the table's key arena.
+*
+* param :
+*   key: the key to input into the table
+*   value: the value associated with the key
+*
+* returns:
+*   bool: true if the key was inserted, false if it was already in the table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::insert(KeyView key, Value value) {
+    return this->insertHashed(key, hash(key), std::move(value));
+}
+
+/**
+* insertHashed: insert for a key whose hash is already known, so a caller that hashed the key to route
+*   it (like ConcurrentHashTable picking a shard) does not hash it again
+*
+* param :
+*   key: the key to input into the table
+*   hashValue: hash(key)
+*   value: the value associated with the key
+*
+* returns:
+*   bool: true if the key was inserted, false if it was already in the table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::insertHashed(KeyView key, size_t hashValue, Value value) {
+    return this->tryEmplaceHashed(key, hashValue, std::move(value)).second;
+}
+
+/**
+* try_emplace: Insert a key-value pair if the key is not in the table yet and give back the value
+*   the key ends up with either way. If the alpha of the table (size/capacity) exceeds the max load
+*   factor (.5 by default) the table is resized by the growth factor (2 by default) and the elements
+*   are rehashed into it. In incremental resize mode the rehash is spread over the following
+*   operations instead.
+*
+* param :
+*   key: the key to input into the table
+*   value: the value associated with the key if it is inserted
+*
+* returns:
+*   std::pair<Value&, bool>: Reference to the key's value and true if the key was inserted
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::pair<Value&, bool> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::try_emplace(KeyView key, Value value) {
+    return this->tryEmplaceHashed(key, hash(key), std::move(value));
+}
+
+/**
+* tryEmplaceHashed: try_emplace for a key whose hash is already known
+*
+* param :
+*   key: the key to input into the table
+*   hashValue: hash(key)
+*   value: the value associated with the key if it is inserted
+*
+* returns:
+*   std::pair<Value&, bool>: Reference to the key's value and true if the key was inserted
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::pair<Value&, bool> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::tryEmplaceHashed(KeyView key, size_t hashValue, Value value) {
+    this->migrateBuckets(this->migrateStep);
+
+    //If the key is already in the table hand back its value, in a cache that counts as a use but not as a lookup hit
+    if (Bucket* bucket = this->findBucket(key, hashValue); bucket != nullptr) {
+        if (this->cacheEntries != 0) {
+            bucket->markReferenced();
+        }
+        return {bucket->getValueRef(), false};
+    }
+
+    //A full cache makes room instead of growing
+    if (this->cacheEntries != 0 and this->numSize >= this->cacheEntries) {
+        this->evictOne();
+    }
+
+    //New keys always go into the current table, even while old buckets are still migrating
+    size_t probes = 0;
+    size_t index = this->placeBucket(this->tableData, this->keyArena.store(key), hashValue, std::move(value), probes);
+    this->numSize++;
+    this->bloomAdd(hashValue);
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        HashTableStats::recordProbeLength(this->counters.insertProbeLengths, probes);
+        HashTableStats::recordMax(this->counters.maxProbeLength, probes);
+    }
+
+    //Resize vector if load rating is greater than the max load factor
+    if (this->alpha() > this->maxLoadFactor and this->cacheEntries == 0) {
+        //Cuckoo tables always rehash in one go since a kick can need any bucket of the new table
+        if (this->incrementalResize and !this->cuckoo) {
+            this->startMigration(this->grownCapacity());
+        }
+        else {
+            this->rehash(this->grownCapacity());
+        }
+        //The bucket moved during the resize so look it up again
+        return {this->findBucket(key, hashValue)->getValueRef(), true};
+    }
+    this->rebuildBloomIfFull();
+    return {this->tableData[index].getValueRef(), true};
+}
+
+/**
+* insert_or_assign: Insert a key-value pair, or set the value of the key if it is already in the table
+*
+* param :
+*   key: the key to input into the table
+*   value: the value the key should have
+*
+* returns:
+*   bool: true if the key was inserted, false if an existing value was replaced
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::insert_or_assign(KeyView key, Value value) {
+    return this->insertOrAssignHashed(key, hash(key), std::move(value));
+}
+
+/**
+* insertOrAssignHashed: insert_or_assign for a key whose hash is already known
+*
+* param :
+*   key: the key to input into the table
+*   hashValue: hash(key)
+*   value: the value the key should have
+*
+* returns:
+*   bool: true if the key was inserted, false if an existing value was replaced
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::insertOrAssignHashed(KeyView key, size_t hashValue, Value value) {
+    auto [curValue, inserted] = this->tryEmplaceHashed(key, hashValue, value);
+    if (!inserted) {
+        curValue = std::move(value);
+    }
+    return inserted;
+}
+
+/**
+* remove: Check if key is in table if it is set the bucket it was in to empty after removal
+*
+* param :
+*   key: the key to check for in the table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::remove(KeyView key) {
+    return this->removeHashed(key, hash(key));
+}
+
+/**
+* removeHashed: remove for a key whose hash is already known
+*
+* param :
+*   key: the key to remove
+*   hashValue: hash(key)
+*
+* returns:
+*   bool: true if the key was removed, false if it was not in the table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::removeHashed(KeyView key, size_t hashValue) {
+    this->migrateBuckets(this->migrateStep);
+
+    //Check if current key is in either table
+    if (Bucket* bucket = this->findBucket(key, hashValue); bucket != nullptr) {
+        this->eraseBucket(bucket);
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+* eraseBucket: take the key out of a filled bucket of either vector table, for remove and cache evictions
+*
+* param :
+*   bucket: the bucket holding the key
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::eraseBucket(Bucket* bucket) {
+    bool inCurrentTable = bucket >= this->tableData.data() and bucket < this->tableData.data() + this->tableData.size();
+    //Lower current size
+    numSize--;
+    //The key's bits stay set until the filter is rebuilt
+    this->bloomStale++;
+
+    //The old table and its arena go away once migration is done, only count the current ones
+    if (inCurrentTable) {
+        this->removedKeyBytes += Storage::keyBytes(bucket->getKey());
+    }
+
+    if (this->robinHood and inCurrentTable) {
+        //Robin Hood tables close the gap instead of leaving a removed bucket behind
+        this->shiftBackFrom(static_cast<size_t>(bucket - this->tableData.data()));
+    }
+    else if (this->cuckoo) {
+        //A cuckoo key is only ever looked for in its own two sets, so its bucket is simply free again
+        this->removeCuckoo(static_cast<size_t>(bucket - this->tableData.data()));
+    }
+    else {
+        //Set bucket type to empty after removal
+        bucket->setBucketType(BucketType::EAR);
+        if (inCurrentTable) {
+            this->numRemoved++;
+        }
+    }
+    this->compactIfNeeded();
+    this->rebuildBloomIfFull();
+}
+
+/**
+* contains: Check if key is in table
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   bool: true if it is in container false if it is not
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::contains(KeyView key) const {
+    return this->containsHashed(key, hash(key));
+}
+
+/**
+* containsHashed: contains for a key whose hash is already known
+*
+* param :
+*   key: the key to check for in the table
+*   hashValue: hash(key)
+*
+* returns:
+*   bool: true if it is in container false if it is not
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::containsHashed(KeyView key, size_t hashValue) const {
+    //If a bucket holds the key in either table the key is in the list
+    const Bucket* bucket = this->findBucket(key, hashValue);
+    this->recordCacheAccess(bucket);
+    return bucket != nullptr;
+}
+
+/**
+* get: Check if key is in table and return the value
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   std::optional<Value>: Value of key if it is in the table or nullopt if key is not in table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::optional<Value> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::get(KeyView key) const {
+    return this->getHashed(key, hash(key));
+}
+
+/**
+* getHashed: get for a key whose hash is already known
+*
+* param :
+*   key: the key to check for in the table
+*   hashValue: hash(key)
+*
+* returns:
+*   std::optional<Value>: Value of key if it is in the table or nullopt if key is not in table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::optional<Value> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getHashed(KeyView key, size_t hashValue) const {
+    //Grab keys current bucket and make sure it exists
+    const Bucket* bucket = this->findBucket(key, hashValue);
+    this->recordCacheAccess(bucket);
+    if (bucket != nullptr) {
+        //Return keys value
+        return bucket->getValue();
+    }
+    else {
+        return std::nullopt;
+    }
+}
+
+/**
+* getBatch: Look up many keys at once. Keys are worked through in windows of BATCH_WINDOW: the whole
+*   window is hashed and its home buckets prefetched before any probe runs, so the cache misses of
+*   different keys overlap instead of being paid one after another like a loop of get() calls.
+*
+* param :
+*   keys: the keys to look up
+*   results: set to each key's value or nullopt, only the first min(keys, results) keys are looked up
+*
+* returns:
+*   size_t: number of keys that were found
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getBatch(std::span<const KeyValue> keys, std::span<std::optional<Value>> results) const {
+    size_t found = 0;
+    this->batchProbe(std::min(keys.size(), results.size()),
+                     [&](size_t i) -> KeyView { return keys[i]; },
+                     [&](size_t i, size_t hashValue) {
+                         const Bucket* bucket = this->findBucket(keys[i], hashValue);
+                         this->recordCacheAccess(bucket);
+                         results[i] = bucket != nullptr ? std::optional<Value>(bucket->getValue()) : std::nullopt;
+                         found += bucket != nullptr;
+                     });
+    return found;
+}
+
+/**
+* containsBatch: Check many keys at once, prefetching the same way as getBatch
+*
+* param :
+*   keys: the keys to check for
+*   results: set to true for each key in the table, only the first min(keys, results) keys are checked.
+*       std::vector<bool> is not contiguous so it cannot be used here, use an array of bool.
+*
+* returns:
+*   size_t: number of keys that were found
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::containsBatch(std::span<const KeyValue> keys, std::span<bool> results) const {
+    size_t found = 0;
+    this->batchProbe(std::min(keys.size(), results.size()),
+                     [&](size_t i) -> KeyView { return keys[i]; },
+                     [&](size_t i, size_t hashValue) {
+                         const Bucket* bucket = this->findBucket(keys[i], hashValue);
+                         this->recordCacheAccess(bucket);
+                         results[i] = bucket != nullptr;
+                         found += results[i];
+                     });
+    return found;
+}
+
+/**
+* insertBatch: Insert many key-value pairs at once, prefetching the same way as getBatch. The table is
+*   grown once up front for all the pairs, unless incremental resize is on since that would rehash
+*   the whole table in one go.
+*
+* param :
+*   pairs: the key-value pairs to insert, keys already in the table keep their value
+*
+* returns:
+*   size_t: number of keys that were inserted
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::insertBatch(std::span<const std::pair<KeyValue, Value>> pairs) {
+    if (!this->incrementalResize) {
+        this->reserve(this->size() + pairs.size());
+    }
+
+    size_t inserted = 0;
+    this->batchProbe(pairs.size(),
+                     [&](size_t i) -> KeyView { return pairs[i].first; },
+                     [&](size_t i, size_t hashValue) {
+                         inserted += this->tryEmplaceHashed(pairs[i].first, hashValue, pairs[i].second).second;
+                     });
+    return inserted;
+}
+
+/**
+* bulkLoad: Insert a large batch of key-value pairs. The table is sized once for all of them, folding
+*   in any incremental resize, so nothing is rehashed part way. Batches big enough to split are
+*   hashed on several threads and then placed by bulkLoadParallel, smaller ones go in one at a time.
+*
+* param :
+*   pairs: the key-value pairs to insert, keys already in the table keep their value and the first
+*     of two equal keys in pairs wins
+*
+* returns:
+*   size_t: number of keys that were inserted
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <PairRangeOf<typename KeyStorage<Key>::View, Value> Range>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::bulkLoad(Range&& pairs) {
+    size_t count = std::ranges::size(pairs);
+    this->migrateBuckets(this->oldTableData.size());
+    this->reserve(this->size() + count);
+
+    //Thread ids have to fit in the claim byte next to 0 and BULK_FILLED. A cache may have to evict, which only inserts one at a time do
+    if (size_t threadCount = std::min<size_t>(this->parallelThreadCount(count), BULK_FILLED - 1); threadCount > 1 and this->cacheEntries == 0) {
+        return this->bulkLoadParallel(pairs, threadCount);
+    }
+    size_t inserted = 0;
+    for (auto&& pair : pairs) {
+        KeyView key = pair.first;
+        inserted += this->tryEmplaceHashed(key, this->hash(key), Value(pair.second)).second;
+    }
+    return inserted;
+}
+
+/**
+* bulkLoadParallel: place a batch of pairs into a table that already has room for all of them.
+*   Every key is hashed, and checked against the keys already in the table, on several threads.
+*   The keys are then split by which slice of the buckets their home bucket falls in, one slice per
+*   thread, so equal keys always land on the same thread. Each thread places its keys in input
+*   order by claiming the first free bucket of their probe sequence, like placeParallel, and tags it
+*   with its thread id. A thread only ever needs to compare a key against buckets it tagged itself,
+*   since an equal key from the batch can only be in one of those and one already in the table was
+*   found up front. Keys go into per thread arenas that are merged at the end.
+*
+* param :
+*   pairs: the key-value pairs to insert
+*   threadCount: the number of threads to use, less than BULK_FILLED
+*
+* returns:
+*   size_t: number of keys that were inserted
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Range>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::bulkLoadParallel(const Range& pairs, size_t threadCount) {
+    size_t count = std::ranges::size(pairs);
+    size_t tableCapacity = this->tableData.size();
+    auto first = std::ranges::begin(pairs);
+    bool checkExisting = this->size() > 0;
+
+    //Hash every key and find which slice of the table it belongs to, keys already in the table get no slice
+    std::vector<size_t> hashes(count);
+    std::vector<uint8_t> slices(count);
+    runParallel(threadCount, count, [&](size_t begin, size_t end, size_t) {
+        size_t probes = 0;
+        for (size_t i = begin; i < end; i++) {
+            KeyView key = first[i].first;
+            hashes[i] = this->hash(key);
+            bool present = checkExisting and this->findIndex(this->tableData, key, hashes[i], probes) != std::nullopt;
+            slices[i] = present ? BULK_FILLED : static_cast<uint8_t>(this->homeIndex(hashes[i], tableCapacity) * threadCount / tableCapacity);
+        }
+    });
+
+    //Group the keys by slice, keeping input order inside each slice
+    std::vector<size_t> sliceStarts(threadCount + 1, 0);
+    for (uint8_t slice : slices) {
+        if (slice != BULK_FILLED) {
+            sliceStarts[slice + 1]++;
+        }
+    }
+    std::partial_sum(sliceStarts.begin(), sliceStarts.end(), sliceStarts.begin());
+    std::vector<size_t> order(sliceStarts[threadCount]);
+    std::vector<size_t> next(sliceStarts.begin(), sliceStarts.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        if (slices[i] != BULK_FILLED) {
+            order[next[slices[i]]++] = i;
+        }
+    }
+
+    std::vector<std::atomic<uint8_t>> claimed(tableCapacity);
+    std::vector<size_t> homes(this->robinHood ? tableCapacity : 0);
+    if (checkExisting) {
+        runParallel(threadCount, tableCapacity, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                if (!this->tableData[i].isEmpty()) {
+                    claimed[i].store(BULK_FILLED, std::memory_order_relaxed);
+                    if (this->robinHood) {
+                        homes[i] = (i + tableCapacity - this->tableData[i].getDistance()) % tableCapacity;
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<typename Storage::Arena> arenas = this->threadArenas(threadCount);
+    std::vector<size_t> inserted(threadCount, 0);
+    std::vector<size_t> reused(threadCount, 0);
+    runParallel(threadCount, threadCount, [&](size_t, size_t, size_t thread) {
+        uint8_t tag = static_cast<uint8_t>(thread + 1);
+        for (size_t o = sliceStarts[thread]; o < sliceStarts[thread + 1]; o++) {
+            size_t i = order[o];
+            KeyView key = first[i].first;
+            size_t step = this->probeStep(hashes[i], tableCapacity);
+            size_t vectorIndex = this->homeIndex(hashes[i], tableCapacity);
+            while (true) {
+                uint8_t state = claimed[vectorIndex].load(std::memory_order_relaxed);
+                if (state == tag and this->keyEqual(this->tableData[vectorIndex].getKey(), key)) {
+                    break;
+                }
+                if (state == 0 and claimed[vectorIndex].compare_exchange_strong(state, tag, std::memory_order_relaxed)) {
+                    Bucket& bucket = this->tableData[vectorIndex];
+                    reused[thread] += !bucket.isEmptySinceStart();
+                    bucket.load(arenas[thread].store(key), Value(first[i].second));
+                    if (this->robinHood) {
+                        homes[vectorIndex] = this->homeIndex(hashes[i], tableCapacity);
+                    }
+                    if (this->bloomFilter) {
+                        this->bloom.addShared(this->seededMix(hashes[i]));
+                    }
+                    inserted[thread]++;
+                    break;
+                }
+                vectorIndex += step;
+                if (vectorIndex >= tableCapacity) {
+                    vectorIndex -= tableCapacity;
+                }
+            }
+        }
+    });
+
+    for (typename Storage::Arena& arena : arenas) {
+        this->keyArena.merge(std::move(arena));
+    }
+    size_t totalInserted = std::accumulate(inserted.begin(), inserted.end(), size_t(0));
+    this->numSize += totalInserted;
+    this->numRemoved -= std::accumulate(reused.begin(), reused.end(), size_t(0));
+    if (this->robinHood) {
+        this->sortRobinHoodClusters(homes, threadCount);
+    }
+    this->rebuildBloomIfFull();
+    return totalInserted;
+}
+
+/**
+* batchProbe: drive a batch operation one window of BATCH_WINDOW keys at a time. Every key in the
+*   window is hashed and its home bucket prefetched, then the key bytes the home buckets point at are
+*   prefetched, and only then is each key resolved.
+*
+* param :
+*   count: number of keys in the batch
+*   keyAt: called with an index, gives back that key
+*   resolve: called with an index and the key's hash once its lines are on their way
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <typename KeyAt, typename Resolve>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::batchProbe(size_t count, KeyAt&& keyAt, Resolve&& resolve) const {
+    std::array<size_t, BATCH_WINDOW> hashes;
+    for (size_t start = 0; start < count; start += BATCH_WINDOW) {
+        size_t windowSize = std::min(BATCH_WINDOW, count - start);
+        for (size_t i = 0; i < windowSize; i++) {
+            hashes[i] = hash(keyAt(start + i));
+            if (this->bloomFilter) {
+                this->bloom.prefetch(this->seededMix(hashes[i]));
+            }
+            this->prefetchHome(hashes[i]);
+        }
+        //The home buckets are arriving by now, so the keys they point at can be requested too
+        for (size_t i = 0; i < windowSize; i++) {
+            this->prefetchHomeKey(hashes[i]);
+        }
+        for (size_t i = 0; i < windowSize; i++) {
+            resolve(start + i, hashes[i]);
+        }
+    }
+}
+
+/**
+* prefetchHome: start loading the home bucket of a hash in the current table
+*
+* param :
+*   hashValue: the hash of the key about to be probed for
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::prefetchHome(size_t hashValue) const {
+    if (this->cuckoo) {
+        auto [first, second] = this->cuckooSets(hashValue, this->tableData.size());
+        prefetchAddress(&this->tableData[first * CUCKOO_SET_SIZE]);
+        prefetchAddress(&this->tableData[second * CUCKOO_SET_SIZE]);
+    }
+    else if (!this->tableData.empty()) {
+        prefetchAddress(&this->tableData[this->homeIndex(hashValue, this->tableData.size())]);
+    }
+}
+
+/**
+* prefetchHomeKey: start loading the key bytes of a hash's home bucket, which live in the arena and
+*   would otherwise be a second cache miss once the bucket itself is loaded
+*
+* param :
+*   hashValue: the hash of the key about to be probed for
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::prefetchHomeKey(size_t hashValue) const {
+    //Keys that are not arena backed are in the bucket itself, which prefetchHome already covers
+    if constexpr (Storage::USES_ARENA) {
+        if (this->tableData.empty()) {
+            return;
+        }
+        size_t home = this->cuckoo ? this->cuckooSets(hashValue, this->tableData.size()).first * CUCKOO_SET_SIZE
+                                   : this->homeIndex(hashValue, this->tableData.size());
+        const Bucket& bucket = this->tableData[home];
+        if (!bucket.isEmpty()) {
+            prefetchAddress(bucket.getKey().data());
+        }
+    }
+}
+
+/**
+* operator []: Check if key is in table and return the reference to the value for assignment purpouses.
+*   A key that is not in the table is inserted with a value initialized Value (0 for numbers) first.
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   Value&: Reference to value of key
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+Value& BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::operator[](KeyView key) {
+    return this->try_emplace(key, Value()).first;
+}
+
+/**
+* keys: Get list of all buckets that are normal in table
+*
+* returns:
+*   std::vector<Key>: List of all non empty buckets keys
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::vector<Key> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::keys() const {
+    std::vector<Key> curKeyList;
+    curKeyList.reserve(this->size());
+    //Iterating only visits filled buckets, including ones in the old table mid resize
+    for (const auto& [key, value] : *this) {
+        curKeyList.emplace_back(key);
+    }
+    return curKeyList;
+}
+
+/**
+* alpha: get the load factor of the vector table comprised of size/capacity
+*
+* returns:
+*   double: size/capacity
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+double BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::alpha() const {
+    return static_cast<double>(this->size())/static_cast<double>(this->capacity());
+}
+
+/**
+* capacity: Get capacity of bucket (total number of buckets)
+*
+* returns:
+*   size_t: Number of total buckets
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::capacity() const {
+    return this->numCapacity;
+}
+
+/**
+* size: Returns number of buckets that are not empty
+*
+* returns:
+*   size_t: List of all non empty buckets keys
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::size() const {
+    return this->numSize;
+}
+
+/**
+* removedCount: Returns number of buckets that are empty after remove. Misses only stop probing at
+*   an empty since start bucket, so these are what make misses slow under churn.
+*
+* returns:
+*   size_t: Number of empty after remove buckets in the current vector table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::removedCount() const {
+    return this->numRemoved;
+}
+
+/**
+* stats: get a snapshot of the probe and resize counters. When HASHTABLE_NO_STATS is defined nothing
+*   is counted and only removedBuckets is filled in.
+*
+* returns:
+*   HashTableStats: copy of the counters with the current removed bucket count
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+HashTableStats BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::stats() const {
+    HashTableStats snapshot = this->counters.snapshot();
+    snapshot.removedBuckets = this->numRemoved;
+    return snapshot;
+}
+
+/**
+* resetStats: set every probe and resize counter back to zero
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::resetStats() {
+    this->counters = HashTableStats();
+}
+
+/**
+* hash: Use the table's hash function to convert a key into a hashed value
+*
+* returns:
+*   size_t: Hashed value of key
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::hash(KeyView key) const {
+    return this->hasher(key);
+}
+
+/**
+* getIndex: get index returns the index of where a key is in the current vector table. While an
+*   incremental resize is running a key that has not migrated yet is not found here.
+*
+* returns:
+*   std::optional<int>: Possible index of key
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::optional<int> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getIndex(KeyView key) const {
+    size_t probes = 0;
+    return this->findIndex(this->tableData, key, hash(key), probes);
+}
+
+/**
+* reserve: Make room for a number of keys up front so inserting them causes no resizes
+*
+* param :
+*   count: the number of keys the table should hold without growing
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::reserve(size_t count) {
+    //A cache keeps the capacity setCacheCapacity gave it
+    if (this->cacheEntries != 0) {
+        return;
+    }
+    size_t newCapacity = this->capacityFor(count);
+    if (newCapacity > this->capacity()) {
+        this->rehash(newCapacity);
+    }
+}
+
+/**
+* shrink_to_fit: Rehash into the smallest table that holds the current keys under the max load factor,
+*   giving back memory after lots of removes
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::shrink_to_fit() {
+    if (this->cacheEntries != 0) {
+        return;
+    }
+    size_t newCapacity = this->capacityFor(this->size());
+    if (newCapacity < this->capacity() or this->isResizing()) {
+        this->rehash(std::min(newCapacity, this->capacity()));
+    }
+}
+
+/**
+* setMaxLoadFactor: set the alpha the table may reach before it grows. Higher values use less memory
+*   but make probe sequences longer. The table grows right away if it is already over the new value.
+*
+* param :
+*   loadFactor: the new max load factor, must be above 0 and below 1
+*
+* returns:
+*   bool: true if the load factor was set, false if it was out of range
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setMaxLoadFactor(double loadFactor) {
+    if (!(loadFactor > 0.0 and loadFactor < 1.0)) {
+        return false;
+    }
+    this->maxLoadFactor = loadFactor;
+    if (this->cacheEntries != 0) {
+        //A cache's bucket count follows from its entries and the load factor, so it is worked out again
+        this->setCacheCapacity(this->cacheEntries);
+    }
+    else {
+        this->reserve(this->size());
+    }
+    return true;
+}
+
+/**
+* getMaxLoadFactor: get the alpha the table may reach before it grows
+*
+* returns:
+*   double: the max load factor
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+double BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getMaxLoadFactor() const {
+    return this->maxLoadFactor;
+}
+
+/**
+* setGrowthFactor: set how much the capacity is multiplied by when the table grows
+*
+* param :
+*   factor: the new growth factor, must be above 1
+*
+* returns:
+*   bool: true if the growth factor was set, false if it was out of range
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setGrowthFactor(double factor) {
+    if (!(factor > 1.0)) {
+        return false;
+    }
+    this->growthFactor = factor;
+    return true;
+}
+
+/**
+* getGrowthFactor: get how much the capacity is multiplied by when the table grows
+*
+* returns:
+*   double: the growth factor
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+double BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getGrowthFactor() const {
+    return this->growthFactor;
+}
+
+/**
+* setIncrementalResize: turn incremental resizing on or off. When on, growing the table keeps the
+*   old vector table alive and every insert, remove and operator[] moves a bounded slice of its
+*   buckets, so no single call pays for the whole rehash. Turning it off finishes any running resize.
+*
+* param :
+*   enabled: true to spread resizes over later operations
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setIncrementalResize(bool enabled) {
+    this->incrementalResize = enabled;
+    if (!enabled) {
+        this->migrateBuckets(this->oldTableData.size());
+    }
+}
+
+/**
+* isResizing: check if an incremental resize is still moving buckets out of the old table
+*
+* returns:
+*   bool: true while the old vector table still exists
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::isResizing() const {
+    return !this->oldTableData.empty();
+}
+
+/**
+* setRehashThreads: set how many threads a full rehash may use. Tables with at least
+*   PARALLEL_BUCKETS_PER_THREAD buckets per thread split the old buckets between threads, which
+*   claim buckets of the new vector table atomically. Incremental resizes always move buckets on the
+*   calling thread.
+*
+* param :
+*   threads: the most threads to use, 0 for one per hardware thread and 1 to never start threads
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setRehashThreads(size_t threads) {
+    this->rehashThreads = threads;
+}
+
+/**
+* getRehashThreads: get the most threads a full rehash may use
+*
+* returns:
+*   size_t: the thread limit, 0 meaning one per hardware thread
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getRehashThreads() const {
+    return this->rehashThreads;
+}
+
+/**
+* setRobinHood: turn Robin Hood mode on or off. In Robin Hood mode keys are probed linearly and an
+*   insert takes the bucket of any key that sits closer to its home than the new key would, so every
+*   key ends up about as far from home as the rest. A lookup can then stop at the first key closer to
+*   its home than the distance searched so far, which bounds the cost of misses, and removes shift
+*   the following keys back instead of leaving empty after remove buckets. The table is rebuilt at
+*   its current capacity to switch layouts. Turning it on turns cuckoo mode off, turning it off ends
+*   cache mode.
+*
+* param :
+*   enabled: true to use Robin Hood probing
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setRobinHood(bool enabled) {
+    if (enabled != this->robinHood) {
+        this->robinHood = enabled;
+        this->cuckoo = this->cuckoo and !enabled;
+        this->cacheEntries = enabled ? this->cacheEntries : 0;
+        this->rehash(this->capacity());
+    }
+}
+
+/**
+* isRobinHood: check if the table uses Robin Hood probing
+*
+* returns:
+*   bool: true if Robin Hood mode is on
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::isRobinHood() const {
+    return this->robinHood;
+}
+
+/**
+* setCuckoo: turn cuckoo mode on or off. In cuckoo mode the table is split into sets of
+*   CUCKOO_SET_SIZE buckets and a key may only sit in one of two sets picked by its hash, or in a
+*   small stash at the end of the table. A lookup reads those two sets and, only if it is not empty,
+*   the stash, however full the table is. An insert that finds both sets full moves a key out to its
+*   other set, which may move another, and so on, so tables stay fast with a max load factor of .9
+*   or more. Resizes always rehash in one go and on one thread in this mode. The table is rebuilt at
+*   its current capacity to switch layouts, and turning it on turns Robin Hood mode off.
+*
+* param :
+*   enabled: true to use cuckoo hashing
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setCuckoo(bool enabled) {
+    if (enabled != this->cuckoo) {
+        //Buckets still in an old table have to be placed the old way first
+        this->migrateBuckets(this->oldTableData.size());
+        this->cuckoo = enabled;
+        this->robinHood = this->robinHood and !enabled;
+        //Caches run on Robin Hood probing, and a failed cuckoo insert would grow the table anyway
+        this->cacheEntries = enabled ? 0 : this->cacheEntries;
+        this->rehash(this->capacity());
+    }
+}
+
+/**
+* isCuckoo: check if the table uses cuckoo hashing
+*
+* returns:
+*   bool: true if cuckoo mode is on
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::isCuckoo() const {
+    return this->cuckoo;
+}
+
+/**
+* setBloomFilter: turn the Bloom filter in front of lookups on or off. With it on a lookup for a
+*   missing key usually reads one cache line of the filter and stops there, instead of walking a
+*   probe sequence through the buckets and key arena. It costs BloomFilter::BITS_PER_KEY bits per key
+*   the table can hold before it grows and a little time on each insert. Turning it on builds it
+*   from the keys in the table, turning it off frees it.
+*
+* param :
+*   enabled: true to keep a Bloom filter
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setBloomFilter(bool enabled) {
+    if (enabled == this->bloomFilter) {
+        return;
+    }
+    this->bloomFilter = enabled;
+    if (enabled) {
+        this->rebuildBloom();
+    }
+    else {
+        this->bloom.clear();
+        this->nextBloom.clear();
+        this->bloomStale = 0;
+    }
+}
+
+/**
+* hasBloomFilter: check if lookups go through a Bloom filter first
+*
+* returns:
+*   bool: true if the Bloom filter is on
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::hasBloomFilter() const {
+    return this->bloomFilter;
+}
+
+/**
+* bloomFilterBytes: get the memory the Bloom filter takes, counting the one being built mid migration
+*
+* returns:
+*   size_t: bytes of filter blocks, 0 if the filter is off
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::bloomFilterBytes() const {
+    return this->bloom.bytesUsed() + this->nextBloom.bytesUsed();
+}
+
+/**
+* setCacheCapacity: turn the table into a cache of at most entries keys, or back into a normal table
+*   with 0. A cache is sized once for its entries at the max load factor and never resizes after
+*   that. Inserting a new key into a full cache evicts one with the CLOCK policy: a hand sweeps over
+*   the buckets, clearing the reference bit every lookup or insert of a key sets, and evicts the
+*   first key it finds whose bit is already clear. Hits stay a single lookup with no list to update.
+*   Keys past entries are evicted right away. Caches use Robin Hood probing, whose removes leave no
+*   empty after remove buckets behind. Clearing those would move keys around under the CLOCK hand,
+*   so keys it had just passed could be evicted before it came round again.
+*
+* param :
+*   entries: the most keys the cache holds, 0 to stop being a cache
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::setCacheCapacity(size_t entries) {
+    this->migrateBuckets(this->oldTableData.size());
+    this->cacheEntries = entries;
+    if (entries == 0) {
+        return;
+    }
+    if (!this->robinHood) {
+        this->robinHood = true;
+        this->cuckoo = false;
+        this->rehash(this->capacity());
+    }
+    while (this->numSize > entries) {
+        this->evictOne();
+    }
+    if (size_t newCapacity = this->capacityFor(entries); newCapacity != this->capacity()) {
+        this->rehash(newCapacity);
+    }
+    this->clockHand = 0;
+}
+
+/**
+* getCacheCapacity: get the most keys the table holds in cache mode
+*
+* returns:
+*   size_t: the cache's entries, 0 if the table is not a cache
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::getCacheCapacity() const {
+    return this->cacheEntries;
+}
+
+/**
+* get_allocator: get the allocator the table's buckets come from
+*
+* returns:
+*   Allocator: a copy of the table's allocator
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+Allocator BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::get_allocator() const {
+    return Allocator(this->tableData.get_allocator());
+}
+
+/**
+* save: write the table to a snapshot file that load() can read back without hashing a single key.
+*   The file is a SnapshotHeader, which holds the probe seed, the hash function's state and the sizing
+*   settings, followed by the current vector table and, mid incremental resize, the old one. Each
+*   vector table is its bucket count and key blob size, the bytes of every key back to back, then
+*   the buckets in chunks of SNAPSHOT_CHUNK: their types, their Robin Hood distances, where each
+*   key ends in the blob (or the keys themselves if they are not arena backed) and their values.
+*   Numbers are written in this machine's byte order.
+*
+*   The hash function is written as it is, so a keyed hash like SipHash puts its secret key in the file
+*   in plain text. Anyone who can read a snapshot can build keys that all collide in the tables loaded
+*   from it, so the file is created readable and writable by its owner only and should be kept that way.
+*
+* param :
+*   path: the file to write, replaced if it exists
+*
+* returns:
+*   bool: true if the whole snapshot was written
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::save(const std::string& path) const requires Snapshottable<Key, Value, Hash> {
+    //Narrow the permissions before the hash state is written
+    if (!createOwnerOnlyFile(path)) {
+        return false;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.keyBytes = Storage::USES_ARENA ? 0 : sizeof(Key);
+    header.valueBytes = sizeof(Value);
+    header.hashBytes = sizeof(Hash);
+    header.probing = this->cuckoo ? 2 : this->robinHood ? 1 : 0;
+    header.size = this->numSize;
+    header.removed = this->numRemoved;
+    header.probeSeed = this->probeSeed;
+    header.removedKeyBytes = this->removedKeyBytes;
+    header.migrateIndex = this->migrateIndex;
+    header.migrateStep = this->migrateStep;
+    header.tableCount = this->isResizing() ? 2 : 1;
+    header.maxLoadFactor = this->maxLoadFactor;
+    header.growthFactor = this->growthFactor;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&this->hasher), sizeof(Hash));
+
+    if (!this->writeTable(out, this->tableData)) {
+        return false;
+    }
+    if (this->isResizing() and !this->writeTable(out, this->oldTableData)) {
+        return false;
+    }
+    out.flush();
+    return out.good();
+}
+
+/**
+* load: replace the table's contents with a snapshot written by save(). Keys are read into one arena
+*   block and buckets are filled in place from the chunks, so nothing is hashed or probed. The file
+*   must come from a table with the same key, value and hash types on a machine with the same byte
+*   order. If the file cannot be read or does not check out the table is left as it was.
+*
+* param :
+*   path: the snapshot file to read
+*
+* returns:
+*   bool: true if the table now holds the snapshot
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::load(const std::string& path) requires Snapshottable<Key, Value, Hash> {
+    std::ifstream in(path, std::ios::binary);
+    SnapshotHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 or header.version != SNAPSHOT_VERSION or
+        header.byteOrder != SNAPSHOT_BYTE_ORDER or header.keyBytes != (Storage::USES_ARENA ? 0 : sizeof(Key)) or
+        header.valueBytes != sizeof(Value) or header.hashBytes != sizeof(Hash) or
+        header.probing > 2 or (header.tableCount != 1 and header.tableCount != 2) or !(header.maxLoadFactor > 0.0 and header.maxLoadFactor < 1.0) or
+        !(header.growthFactor > 1.0)) {
+        return false;
+    }
+
+    //Fill a new table and only swap it in once everything checked out
+    BasicHashTable loaded(1, this->hasher, this->keyEqual, this->tableData.get_allocator());
+    if (!in.read(reinterpret_cast<char*>(&loaded.hasher), sizeof(Hash))) {
+        return false;
+    }
+    size_t filled = 0;
+    if (!loaded.readTable(in, loaded.tableData, loaded.keyArena, filled) or loaded.tableData.empty() or
+        (header.probing == 2 and loaded.tableData.size() < CUCKOO_STASH_SIZE + CUCKOO_SET_SIZE) or
+        (header.probing == 0 and !std::has_single_bit(loaded.tableData.size()))) {
+        return false;
+    }
+    if (header.tableCount == 2) {
+        if (!loaded.readTable(in, loaded.oldTableData, loaded.oldKeyArena, filled) or loaded.oldTableData.empty() or
+            header.migrateIndex >= loaded.oldTableData.size() or
+            (header.probing == 0 and !std::has_single_bit(loaded.oldTableData.size()))) {
+            return false;
+        }
+    }
+    size_t removed = std::count_if(loaded.tableData.begin(), loaded.tableData.end(), [](const Bucket& bucket) {
+        return bucket.isEmpty() and !bucket.isEmptySinceStart();
+    });
+    if (filled != header.size or removed != header.removed) {
+        return false;
+    }
+
+    loaded.numCapacity = loaded.tableData.size();
+    loaded.numSize = header.size;
+    loaded.numRemoved = header.removed;
+    loaded.probeSeed = header.probeSeed;
+    loaded.removedKeyBytes = header.removedKeyBytes;
+    loaded.migrateIndex = header.tableCount == 2 ? header.migrateIndex : 0;
+    loaded.migrateStep = std::max<size_t>(header.migrateStep, 1);
+    loaded.incrementalResize = this->incrementalResize;
+    loaded.robinHood = header.probing == 1;
+    loaded.cuckoo = header.probing == 2;
+    loaded.maxLoadFactor = header.maxLoadFactor;
+    loaded.growthFactor = header.growthFactor;
+    loaded.bloomFilter = this->bloomFilter;
+    size_t entries = this->cacheEntries;
+    *this = std::move(loaded);
+    //Snapshots leave the filter out since it is quick to build from the keys
+    if (this->bloomFilter) {
+        this->rebuildBloom();
+    }
+    //A cache stays a cache of the same size, evicting what does not fit
+    if (entries != 0) {
+        this->setCacheCapacity(entries);
+    }
+    return true;
+}
+
+/**
+* begin: get an iterator to the first filled bucket
+*
+* returns:
+*   iterator: Iterator at the first key-value pair, or end() if the table is empty
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::begin() -> iterator {
+    return iterator(this->tableData.data(), this->tableData, this->oldTableData);
+}
+
+/**
+* end: get the past the end iterator
+*
+* returns:
+*   iterator: Iterator one past the last bucket of the last vector table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::end() -> iterator {
+    BucketVector& lastTable = this->isResizing() ? this->oldTableData : this->tableData;
+    return iterator(lastTable.data() + lastTable.size());
+}
+
+/**
+* begin: get a const iterator to the first filled bucket
+*
+* returns:
+*   const_iterator: Iterator at the first key-value pair, or end() if the table is empty
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::begin() const -> const_iterator {
+    return const_iterator(this->tableData.data(), this->tableData, this->oldTableData);
+}
+
+/**
+* end: get the past the end const iterator
+*
+* returns:
+*   const_iterator: Iterator one past the last bucket of the last vector table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::end() const -> const_iterator {
+    const BucketVector& lastTable = this->isResizing() ? this->oldTableData : this->tableData;
+    return const_iterator(lastTable.data() + lastTable.size());
+}
+
+/**
+* cbegin: get a const iterator to the first filled bucket
+*
+* returns:
+*   const_iterator: Iterator at the first key-value pair
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::cbegin() const -> const_iterator {
+    return this->begin();
+}
+
+/**
+* cend: get the past the end const iterator
+*
+* returns:
+*   const_iterator: Iterator one past the last bucket
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::cend() const -> const_iterator {
+    return this->end();
+}
+
+/**
+* capacityFor: get the smallest capacity that holds a number of keys without going over the max load factor
+*
+* param :
+*   count: the number of keys
+*
+* returns:
+*   size_t: the capacity needed, at least 1
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::capacityFor(size_t count) const {
+    size_t newCapacity = std::max<size_t>(static_cast<size_t>(std::ceil(static_cast<double>(count) / this->maxLoadFactor)), 1);
+    while (static_cast<double>(count) > this->maxLoadFactor * static_cast<double>(newCapacity)) {
+        newCapacity++;
+    }
+    return this->fitCapacity(newCapacity);
+}
+
+/**
+* findIndex: probe a vector table for the bucket holding a key
+*
+* param :
+*   table: the vector table to search, its size is used as the capacity
+*   key: the key to look for
+*   hashValue: hash(key)
+*   probes: has the number of buckets looked at added to it
+*
+* returns:
+*   std::optional<size_t>: Index of the key's bucket or nullopt if it is not in the table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::optional<size_t> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::findIndex(const BucketVector& table, KeyView key, size_t hashValue,
+                                           size_t& probes) const {
+    size_t tableCapacity = table.size();
+    if (tableCapacity == 0) {
+        return std::nullopt;
+    }
+
+    if (this->cuckoo) {
+        //The key can only be in its two sets or the stash, and the stash is kept packed from its start
+        auto [first, second] = this->cuckooSets(hashValue, tableCapacity);
+        for (size_t set : {first, second}) {
+            for (size_t vectorIndex = set * CUCKOO_SET_SIZE; vectorIndex < (set + 1) * CUCKOO_SET_SIZE; vectorIndex++) {
+                probes++;
+                if (!table[vectorIndex].isEmpty() and table[vectorIndex].getDistance() == cuckooTag(hashValue) and
+                    this->keyEqual(table[vectorIndex].getKey(), key)) {
+                    return vectorIndex;
+                }
+            }
+        }
+        size_t stashStart = (tableCapacity - CUCKOO_STASH_SIZE) / CUCKOO_SET_SIZE * CUCKOO_SET_SIZE;
+        for (size_t vectorIndex = stashStart; vectorIndex < tableCapacity and !table[vectorIndex].isEmpty(); vectorIndex++) {
+            probes++;
+            if (table[vectorIndex].getDistance() == cuckooTag(hashValue) and this->keyEqual(table[vectorIndex].getKey(), key)) {
+                return vectorIndex;
+            }
+        }
+        return std::nullopt;
+    }
+
+    size_t vectorIndex = this->homeIndex(hashValue, tableCapacity);
+    //Most lookups end at the home bucket, so the step is only worked out once it has missed
+    size_t step = 0;
+    //Probe for proper location of key value pair
+    for (size_t i = 0; i < tableCapacity; i++) {
+        //If you found an empty bucket return nullopt the key is not in the vector table
+        if (table[vectorIndex].isEmptySinceStart()) {
+            probes += i + 1;
+            return std::nullopt;
+        }
+
+        //If key matches and bucket is not empty then return index
+        if ((!table[vectorIndex].isEmpty()) and this->keyEqual(table[vectorIndex].getKey(), key)) {
+            probes += i + 1;
+            return vectorIndex;
+        }
+
+        //A Robin Hood insert would have taken this bucket from a key closer to its home, so the key is not further on.
+        //Removed buckets only show up in an old table mid resize and are skipped
+        if (this->robinHood and !table[vectorIndex].isEmpty() and table[vectorIndex].getDistance() < i) {
+            probes += i + 1;
+            return std::nullopt;
+        }
+
+        if (step == 0) {
+            step = this->probeStep(hashValue, tableCapacity);
+        }
+        vectorIndex += step;
+        if (vectorIndex >= tableCapacity) {
+            vectorIndex -= tableCapacity;
+        }
+    }
+    probes += tableCapacity;
+    return std::nullopt;
+}
+
+/**
+* findBucket: find the bucket holding a key, looking in the old vector table too while a resize
+*   is running
+*
+* param :
+*   key: the key to look for
+*   hashValue: hash(key), for callers that already computed it
+*
+* returns:
+*   Bucket*: Pointer to the key's bucket or nullptr if the key is not in the table
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::findBucket(KeyView key, size_t hashValue) const -> const Bucket* {
+    if (this->bloomFilter and !this->bloom.mayContain(this->seededMix(hashValue))) {
+        if constexpr (HASHTABLE_STATS_ENABLED) {
+            HashTableStats::count(this->counters.bloomRejects);
+        }
+        return nullptr;
+    }
+
+    size_t probes = 0;
+    const Bucket* bucket = nullptr;
+    if (std::optional<size_t> index = this->findIndex(this->tableData, key, hashValue, probes); index != std::nullopt) {
+        bucket = &this->tableData[index.value()];
+    }
+    else if (std::optional<size_t> index = this->findIndex(this->oldTableData, key, hashValue, probes); index != std::nullopt) {
+        bucket = &this->oldTableData[index.value()];
+    }
+
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        HashTableStats::recordProbeLength(bucket != nullptr ? this->counters.hitProbeLengths : this->counters.missProbeLengths, probes);
+        HashTableStats::recordMax(this->counters.maxProbeLength, probes);
+        if (this->bloomFilter and bucket == nullptr) {
+            HashTableStats::count(this->counters.bloomFalsePositives);
+        }
+    }
+    return bucket;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::findBucket(KeyView key, size_t hashValue) -> Bucket* {
+    return const_cast<Bucket*>(std::as_const(*this).findBucket(key, hashValue));
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::findBucket(KeyView key) const -> const Bucket* {
+    return this->findBucket(key, hash(key));
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::findBucket(KeyView key) -> Bucket* {
+    return this->findBucket(key, hash(key));
+}
+
+/**
+* placeBucket: load a key-value pair into the first empty bucket of its probe sequence. Callers
+*   make sure the key is not already in the table.
+*
+* param :
+*   table: the vector table to insert into
+*   key: the key to input into the table, already stored in an arena
+*   hashValue: hash(key)
+*   value: the value associated with the key
+*   probes: set to the number of buckets looked at
+*
+* returns:
+*   size_t: Index of the bucket the key was loaded into
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::placeBucket(BucketVector& table, KeyView key, size_t hashValue, Value value,
+                              size_t& probes) {
+    if (this->robinHood) {
+        return this->placeRobinHood(table, key, hashValue, std::move(value), probes);
+    }
+    if (this->cuckoo) {
+        //Cuckoo tables are only ever filled in place, so a key left over can grow the table and try again
+        Bucket carried(key, std::move(value));
+        carried.setDistance(cuckooTag(hashValue));
+        size_t carriedHash = hashValue;
+        std::optional<size_t> index = this->placeCuckoo(this->tableData, carried, carriedHash, probes);
+        if (index) {
+            return index.value();
+        }
+
+        //The key being placed and the one left over are copied out before the rehash frees the arena they point into
+        std::vector<typename Storage::Arena> holder = this->threadArenas(1);
+        typename Storage::Stored placedKey = holder.front().store(key);
+        while (!index) {
+            carriedHash = this->hash(carried.getKey());
+            carried.load(holder.front().store(carried.getKey()), std::move(carried.getValueRef()));
+            this->rehash(this->grownCapacity());
+            carried.load(this->keyArena.store(carried.getKey()), std::move(carried.getValueRef()));
+            index = this->placeCuckoo(this->tableData, carried, carriedHash, probes);
+        }
+        //The rebuilt filter only has the keys that were in the table, the caller adds the one being placed
+        this->bloomAdd(carriedHash);
+        return this->findIndex(this->tableData, placedKey, hashValue, probes).value();
+    }
+
+    size_t tableCapacity = table.size();
+    size_t vectorIndex = this->homeIndex(hashValue, tableCapacity);
+    size_t step = 0;
+    probes = 1;
+    //Probe for first empty bucket, the step visits every bucket so one is found if alpha < 1
+    while (!table[vectorIndex].isEmpty()) {
+        if (step == 0) {
+            step = this->probeStep(hashValue, tableCapacity);
+        }
+        probes++;
+        vectorIndex += step;
+        if (vectorIndex >= tableCapacity) {
+            vectorIndex -= tableCapacity;
+        }
+    }
+
+    //Reusing an empty after remove bucket of the current table takes it off the removed count
+    if (&table == &this->tableData and !table[vectorIndex].isEmptySinceStart()) {
+        this->numRemoved--;
+    }
+    table[vectorIndex].load(key, std::move(value));
+    return vectorIndex;
+}
+
+/**
+* placeRobinHood: load a key-value pair into a Robin Hood table. Walking linearly from the key's home
+*   bucket, the pair being placed swaps into any bucket whose key is closer to its own home, and the
+*   displaced pair carries on from there until an empty bucket takes whatever is left over.
+*
+* param :
+*   table: the vector table to insert into, holds no empty after remove buckets
+*   key: the key to input into the table, already stored in an arena
+*   hashValue: hash(key)
+*   value: the value associated with the key
+*   probes: set to the number of buckets looked at
+*
+* returns:
+*   size_t: Index of the bucket the key was loaded into
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::placeRobinHood(BucketVector& table, KeyView key, size_t hashValue, Value value,
+                                 size_t& probes) {
+    size_t tableCapacity = table.size();
+    size_t vectorIndex = this->homeIndex(hashValue, tableCapacity);
+    std::optional<size_t> keyIndex;
+    Bucket carried(key, std::move(value));
+    probes = 1;
+    //In a cache a displaced key pushed past the CLOCK hand gets its reference bit back, or the hand would
+    //reach it again right after clearing it
+    bool cacheHand = this->cacheEntries != 0 and &table == &this->tableData;
+    while (!table[vectorIndex].isEmpty()) {
+        if (cacheHand and keyIndex and vectorIndex == this->clockHand) {
+            carried.markReferenced();
+        }
+        if (table[vectorIndex].getDistance() < carried.getDistance()) {
+            std::swap(table[vectorIndex], carried);
+            if (!keyIndex) {
+                keyIndex = vectorIndex;
+            }
+        }
+        carried.setDistance(carried.getDistance() + 1);
+        probes++;
+        vectorIndex = vectorIndex + 1 < tableCapacity ? vectorIndex + 1 : 0;
+    }
+
+    if (cacheHand and keyIndex and vectorIndex == this->clockHand) {
+        carried.markReferenced();
+    }
+    table[vectorIndex] = std::move(carried);
+    return keyIndex.value_or(vectorIndex);
+}
+
+/**
+* placeCuckoo: load a key-value pair into a cuckoo table. If either of the key's sets has an empty
+*   bucket the pair goes there. Otherwise it takes the bucket of a key picked at random, never the
+*   set that key was just kicked out of, and the kicked out key is placed the same way in its other
+*   set. After CUCKOO_MAX_KICKS kicks the key still being carried goes into the stash.
+*
+* param :
+*   table: the vector table to insert into
+*   carried: the pair to place, holds the key left without a bucket if nullopt is returned
+*   hashValue: hash of the key in carried
+*   probes: has the number of buckets looked at added to it
+*
+* returns:
+*   std::optional<size_t>: Index of the bucket carried's key was loaded into, or nullopt if the
+*     stash was full. The first key may then be in the table and another left over in carried.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::optional<size_t> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::placeCuckoo(BucketVector& table, Bucket& carried, size_t hashValue,
+                                                        size_t& probes) {
+    size_t tableCapacity = table.size();
+    std::optional<size_t> keyIndex;
+    size_t kickedFrom = tableCapacity;
+    //xorshift64 state for picking which key to kick out, never 0
+    uint64_t random = this->seededMix(hashValue) | 1;
+
+    for (size_t kicks = 0; kicks <= CUCKOO_MAX_KICKS; kicks++) {
+        auto [first, second] = this->cuckooSets(hashValue, tableCapacity);
+        for (size_t set : {first, second}) {
+            for (size_t vectorIndex = set * CUCKOO_SET_SIZE; vectorIndex < (set + 1) * CUCKOO_SET_SIZE; vectorIndex++) {
+                probes++;
+                if (table[vectorIndex].isEmpty()) {
+                    table[vectorIndex] = std::move(carried);
+                    return keyIndex.value_or(vectorIndex);
+                }
+            }
+        }
+
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        size_t set = first == kickedFrom ? second : second == kickedFrom ? first : (random & 1) != 0 ? second : first;
+        size_t vectorIndex = set * CUCKOO_SET_SIZE + (random >> 32) % CUCKOO_SET_SIZE;
+        std::swap(table[vectorIndex], carried);
+        keyIndex = keyIndex.value_or(vectorIndex);
+        kickedFrom = set;
+        hashValue = this->hash(carried.getKey());
+    }
+
+    size_t stashStart = (tableCapacity - CUCKOO_STASH_SIZE) / CUCKOO_SET_SIZE * CUCKOO_SET_SIZE;
+    for (size_t vectorIndex = stashStart; vectorIndex < tableCapacity; vectorIndex++) {
+        probes++;
+        if (table[vectorIndex].isEmpty()) {
+            table[vectorIndex] = std::move(carried);
+            return keyIndex.value_or(vectorIndex);
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+* cuckooSets: get the two sets a key may sit in. The first comes from the hash and the second from
+*   the hash mixed with the table's seed, and they differ whenever there is more than one set.
+*
+* param :
+*   hashValue: the hashed value of the key
+*   tableCapacity: the number of buckets in the table, stash included
+*
+* returns:
+*   std::pair<size_t, size_t>: the key's first and second set, buckets [set * CUCKOO_SET_SIZE, + CUCKOO_SET_SIZE)
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+std::pair<size_t, size_t> BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::cuckooSets(size_t hashValue, size_t tableCapacity) const {
+    size_t setCount = (tableCapacity - CUCKOO_STASH_SIZE) / CUCKOO_SET_SIZE;
+    size_t first = hashValue % setCount;
+    size_t second = this->seededMix(hashValue) % setCount;
+    if (second == first and setCount > 1) {
+        second = first + 1 < setCount ? first + 1 : 0;
+    }
+    return {first, second};
+}
+
+/**
+* cuckooTag: get the part of a hash cuckoo buckets keep next to their key. The sets come from the low
+*   bits of the hash, so the top half still tells keys of the same set apart.
+*
+* param :
+*   hashValue: the hashed value of the key
+*
+* returns:
+*   uint32_t: the top 32 bits of the hash
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+uint32_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::cuckooTag(size_t hashValue) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(hashValue) >> 32);
+}
+
+/**
+* removeCuckoo: empty a bucket of a cuckoo table. A stash bucket is filled with the last key of the
+*   stash so the stash stays packed and lookups can stop at its first empty bucket.
+*
+* param :
+*   index: the bucket being emptied
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::removeCuckoo(size_t index) {
+    size_t tableCapacity = this->tableData.size();
+    size_t stashStart = (tableCapacity - CUCKOO_STASH_SIZE) / CUCKOO_SET_SIZE * CUCKOO_SET_SIZE;
+    if (index >= stashStart) {
+        size_t last = index;
+        while (last + 1 < tableCapacity and !this->tableData[last + 1].isEmpty()) {
+            last++;
+        }
+        if (last != index) {
+            this->tableData[index] = std::move(this->tableData[last]);
+            index = last;
+        }
+    }
+    this->tableData[index].load(typename Storage::Stored(), Value());
+    this->tableData[index].setBucketType(BucketType::ESS);
+}
+
+/**
+* shiftBackFrom: empty a bucket of a Robin Hood table by moving each following key that is not in
+*   its home bucket back one place, stopping at an empty bucket or a key already at home. Keys stay
+*   in probe order, so no empty after remove marker is needed.
+*
+* param :
+*   index: the bucket being emptied
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::shiftBackFrom(size_t index) {
+    size_t tableCapacity = this->tableData.size();
+    size_t next = index + 1 < tableCapacity ? index + 1 : 0;
+    while (!this->tableData[next].isEmpty() and this->tableData[next].getDistance() > 0) {
+        this->tableData[index] = std::move(this->tableData[next]);
+        this->tableData[index].setDistance(this->tableData[index].getDistance() - 1);
+        index = next;
+        next = index + 1 < tableCapacity ? index + 1 : 0;
+    }
+    this->tableData[index].load(typename Storage::Stored(), Value());
+    this->tableData[index].setBucketType(BucketType::ESS);
+    this->tableData[index].setDistance(0);
+}
+
+/**
+* homeIndex: get the bucket a key's probe sequence starts at. Double hashing tables are powers of two
+*   so this is a mask, Robin Hood tables take any capacity and use the remainder.
+*
+* param :
+*   hashValue: the hashed value of the key
+*   tableCapacity: the number of buckets in the table being probed
+*
+* returns:
+*   size_t: Index of the key's home bucket
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::homeIndex(size_t hashValue, size_t tableCapacity) const {
+    if (this->robinHood) {
+        return hashValue % tableCapacity;
+    }
+    return hashValue & (tableCapacity - 1);
+}
+
+/**
+* probeStep: get the distance between consecutive probes for a key. The step is derived from the
+*   key's hash mixed with this table's seed and is always odd, and double hashing tables are always
+*   powers of two, so stepping from the home bucket visits every bucket exactly once before repeating.
+*   This replaces a stored list of random offsets, so no per-bucket probe data has to be built or kept.
+*
+* param :
+*   hashValue: the hashed value of the key being probed for
+*   tableCapacity: the number of buckets in the table being probed
+*
+* returns:
+*   size_t: Step between probes in the range [1, capacity)
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::probeStep(size_t hashValue, size_t tableCapacity) const {
+    //Robin Hood distances and backward shifts only work with linear probing
+    if (this->robinHood or tableCapacity <= 2) {
+        return 1;
+    }
+
+    //Mix the seed into the hash so each table walks its own permutation, any odd step is coprime with a power of two
+    return (this->seededMix(hashValue) | 1) & (tableCapacity - 1);
+}
+
+/**
+* fitCapacity: get the capacity a table of this mode is actually built with. Double hashing needs a
+*   power of two for its mask and odd steps, Robin Hood and cuckoo tables take the capacity as asked.
+*
+* param :
+*   capacity: the capacity wanted
+*
+* returns:
+*   size_t: capacity, rounded up to a power of two for double hashing
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::fitCapacity(size_t capacity) const {
+    if (this->robinHood or this->cuckoo) {
+        return capacity;
+    }
+    return std::bit_ceil(std::max<size_t>(capacity, 1));
+}
+
+/**
+* seededMix: mix this table's seed into a hash with the splitmix64 finalizer, for a second hash that
+*   does not follow from the first
+*
+* param :
+*   hashValue: the hashed value of a key
+*
+* returns:
+*   size_t: the mixed hash
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::seededMix(size_t hashValue) const {
+    size_t mixed = hashValue ^ this->probeSeed;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    return mixed ^ (mixed >> 31);
+}
+
+/**
+* grownCapacity: get the capacity the table grows to, the current one times the growth factor
+*
+* returns:
+*   size_t: the next capacity, at least one more than the current one
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::grownCapacity() const {
+    return this->fitCapacity(
+        std::max(this->capacity() + 1, static_cast<size_t>(std::ceil(static_cast<double>(this->capacity()) * this->growthFactor))));
+}
+
+/**
+* bloomAdd: add a newly placed key to the Bloom filter, and to the one being built mid migration
+*
+* param :
+*   hashValue: hash of the key
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::bloomAdd(size_t hashValue) {
+    if (!this->bloomFilter) {
+        return;
+    }
+    //The filter uses the top half of the hash to pick a block, so hashes from weak hash functions are mixed first
+    size_t mixed = this->seededMix(hashValue);
+    this->bloom.add(mixed);
+    if (this->isResizing()) {
+        this->nextBloom.add(mixed);
+    }
+}
+
+/**
+* bloomKeyCount: get how many keys to size the Bloom filter for, the most the current capacity
+*   holds before the table grows
+*
+* returns:
+*   size_t: the key count for BloomFilter::reset
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::bloomKeyCount() const {
+    return std::max(this->numSize, static_cast<size_t>(this->maxLoadFactor * static_cast<double>(this->capacity()))) + 1;
+}
+
+/**
+* rebuildBloom: build the Bloom filter again from the keys in both vector tables, dropping the bits
+*   of removed keys. Mid migration the filter for the new table is rebuilt from its keys as well.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::rebuildBloom() {
+    this->bloom.reset(this->bloomKeyCount());
+    if (this->isResizing()) {
+        this->nextBloom.reset(this->bloomKeyCount());
+    }
+    for (const BucketVector* table : {&this->tableData, &this->oldTableData}) {
+        for (const Bucket& bucket : *table) {
+            if (!bucket.isEmpty()) {
+                size_t mixed = this->seededMix(hash(bucket.getKey()));
+                this->bloom.add(mixed);
+                if (table == &this->tableData and this->isResizing()) {
+                    this->nextBloom.add(mixed);
+                }
+            }
+        }
+    }
+    this->bloomStale = 0;
+}
+
+/**
+* rebuildBloomIfFull: rebuild the Bloom filter once it holds more live keys than it was sized for,
+*   which happens after the max load factor was raised, or once removed keys reach half of that. The
+*   false positive rate creeps up to under 1% before that point, and a rebuild costs at most two
+*   hashes per remove since the last one. A rebuild hashes every key, so incremental tables start a
+*   same capacity migration instead, which fills nextBloom a slice at a time while the stale filter
+*   keeps answering. Mid migration the filter being built takes over soon anyway, so nothing is done.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::rebuildBloomIfFull() {
+    if (!this->bloomFilter or this->isResizing()) {
+        return;
+    }
+    if (this->numSize > this->bloom.capacity() or this->bloomStale > this->bloom.capacity() / 2) {
+        if (this->compactsByMigrating()) {
+            this->startCompaction();
+        }
+        else {
+            this->rebuildBloom();
+        }
+    }
+}
+
+/**
+* evictOne: evict the next key the CLOCK hand finds with its reference bit clear, clearing the bits it
+*   passes on the way. Two sweeps at most, since the first clears every bit. The Robin Hood remove
+*   shifts the next key back into the evicted bucket, so the hand stays put for it.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::evictOne() {
+    if (this->numSize == 0) {
+        return;
+    }
+    size_t tableCapacity = this->tableData.size();
+    this->clockHand = this->clockHand < tableCapacity ? this->clockHand : 0;
+    while (true) {
+        Bucket& bucket = this->tableData[this->clockHand];
+        if (!bucket.isEmpty()) {
+            if (!bucket.isReferenced()) {
+                break;
+            }
+            bucket.setReferenced(false);
+        }
+        this->clockHand = this->clockHand + 1 < tableCapacity ? this->clockHand + 1 : 0;
+    }
+
+    this->eraseBucket(&this->tableData[this->clockHand]);
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        this->counters.cacheEvictions++;
+    }
+}
+
+/**
+* recordCacheAccess: in cache mode set the reference bit of a bucket a get or contains found and count
+*   the hit, or count the miss
+*
+* param :
+*   bucket: the bucket found, or nullptr for a miss
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::recordCacheAccess(const Bucket* bucket) const {
+    if (this->cacheEntries == 0) {
+        return;
+    }
+    if (bucket != nullptr) {
+        bucket->markReferenced();
+    }
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        HashTableStats::count(bucket != nullptr ? this->counters.cacheHits : this->counters.cacheMisses);
+    }
+}
+
+/**
+* rehash: Move every key-value pair into a new vector table of the given capacity. Buckets are
+*   read straight out of the old table, so no keys list or lookups are needed. Keys are copied into
+*   a fresh arena so bytes of removed keys are dropped along with the old one.
+*
+* param :
+*   newCapacity: the number of buckets the new table should have
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::rehash(size_t newCapacity) {
+    //Any resize still running is folded into this one
+    this->migrateBuckets(this->oldTableData.size());
+    auto start = std::chrono::steady_clock::now();
+    if (this->cuckoo) {
+        newCapacity = std::max(newCapacity, CUCKOO_STASH_SIZE + CUCKOO_SET_SIZE);
+    }
+    //Switching back to double hashing can leave a capacity that is not a power of two
+    newCapacity = this->fitCapacity(newCapacity);
+
+    BucketVector oldDataTable = std::move(this->tableData);
+    //Keeps the old keys alive until they have been copied into the new arena
+    [[maybe_unused]] typename Storage::Arena oldArena = std::move(this->keyArena);
+    this->tableData.clear();
+    this->tableData.resize(newCapacity);
+    this->numCapacity = newCapacity;
+    this->removedKeyBytes = 0;
+    this->numRemoved = 0;
+    if (this->bloomFilter) {
+        this->bloom.reset(this->bloomKeyCount());
+        this->bloomStale = 0;
+    }
+
+    //Go through old table and find a new location for each filled bucket
+    if (size_t threadCount = this->parallelThreadCount(oldDataTable.size()); threadCount > 1) {
+        this->placeParallel(oldDataTable.size(), [&oldDataTable](size_t i) {
+            Bucket& bucket = oldDataTable[i];
+            return bucket.isEmpty() ? nullptr : &bucket;
+        }, threadCount);
+    }
+    else {
+        size_t probes = 0;
+        for (Bucket& bucket : oldDataTable) {
+            if (!bucket.isEmpty()) {
+                size_t hashValue = hash(bucket.getKey());
+                this->placeBucket(this->tableData, this->keyArena.store(bucket.getKey()), hashValue, std::move(bucket.getValueRef()), probes);
+                //Added after placing since a cuckoo placement can rehash again, which starts the filter over
+                this->bloomAdd(hashValue);
+            }
+        }
+    }
+
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        this->counters.resizeCount++;
+        this->counters.resizeTime += std::chrono::steady_clock::now() - start;
+    }
+}
+
+/**
+* parallelThreadCount: get how many threads to split work over a number of buckets between
+*
+* param :
+*   work: the number of buckets to go through
+*
+* returns:
+*   size_t: threads to use, 1 if the work should stay on the calling thread
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::parallelThreadCount(size_t work) const {
+    //Cuckoo kicks move keys that other threads could be placing
+    if (this->cuckoo) {
+        return 1;
+    }
+    size_t threads = this->rehashThreads != 0 ? this->rehashThreads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return std::max<size_t>(std::min(threads, work / PARALLEL_BUCKETS_PER_THREAD), 1);
+}
+
+/**
+* runParallel: split [0, count) into threadCount even slices and run work(begin, end, thread) on each,
+*   the last slice on the calling thread. Returns once every slice is done.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Work>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::runParallel(size_t threadCount, size_t count, Work&& work) {
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t t = 0; t + 1 < threadCount; t++) {
+        threads.emplace_back([&work, t, threadCount, count] {
+            work(count * t / threadCount, count * (t + 1) / threadCount, t);
+        });
+    }
+    work(count * (threadCount - 1) / threadCount, count, threadCount - 1);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+* placeParallel: load entries into the empty current vector table from several threads. Each thread
+*   takes a slice of the entries, stores their keys in an arena of its own and claims the first free
+*   bucket of each key's probe sequence with an atomic exchange, so no two threads write the same
+*   bucket. The arenas are merged into the table's afterwards. In Robin Hood mode keys are placed by
+*   plain linear probing and then put in Robin Hood order by sortRobinHoodClusters.
+*
+* param :
+*   count: the number of entries
+*   entryAt: gives a Bucket* holding entry i's key and value (the value is moved out), or nullptr to skip it
+*   threadCount: the number of threads to use
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+template <typename EntryAt>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::placeParallel(size_t count, EntryAt&& entryAt, size_t threadCount) {
+    size_t tableCapacity = this->tableData.size();
+    std::vector<std::atomic<uint8_t>> claimed(tableCapacity);
+    std::vector<size_t> homes(this->robinHood ? tableCapacity : 0);
+    std::vector<typename Storage::Arena> arenas = this->threadArenas(threadCount);
+
+    runParallel(threadCount, count, [&](size_t begin, size_t end, size_t thread) {
+        for (size_t i = begin; i < end; i++) {
+            Bucket* entry = entryAt(i);
+            if (entry == nullptr) {
+                continue;
+            }
+            KeyView key = arenas[thread].store(entry->getKey());
+            size_t hashValue = this->hash(key);
+            size_t step = this->probeStep(hashValue, tableCapacity);
+            size_t vectorIndex = this->homeIndex(hashValue, tableCapacity);
+            while (claimed[vectorIndex].exchange(1, std::memory_order_relaxed) != 0) {
+                vectorIndex += step;
+                if (vectorIndex >= tableCapacity) {
+                    vectorIndex -= tableCapacity;
+                }
+            }
+            this->tableData[vectorIndex].load(key, std::move(entry->getValueRef()));
+            if (this->robinHood) {
+                homes[vectorIndex] = this->homeIndex(hashValue, tableCapacity);
+            }
+            if (this->bloomFilter) {
+                this->bloom.addShared(this->seededMix(hashValue));
+            }
+        }
+    });
+
+    for (typename Storage::Arena& arena : arenas) {
+        this->keyArena.merge(std::move(arena));
+    }
+    if (this->robinHood) {
+        this->sortRobinHoodClusters(homes, threadCount);
+    }
+}
+
+/**
+* threadArenas: make one key arena per thread for a parallel load, each allocating from the same
+*   memory resource as the table's own arena so merged keys end up in the same memory
+*
+* param :
+*   threadCount: the number of arenas
+*
+* returns:
+*   std::vector<Arena>: the empty arenas
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::threadArenas(size_t threadCount) const -> std::vector<typename Storage::Arena> {
+    std::vector<typename Storage::Arena> arenas;
+    arenas.reserve(threadCount);
+    for (size_t t = 0; t < threadCount; t++) {
+        arenas.emplace_back(memoryResourceOf(this->tableData.get_allocator()));
+    }
+    return arenas;
+}
+
+/**
+* sortRobinHoodClusters: turn a table filled by linear probing in any order into Robin Hood order.
+*   Linear probing fills the same buckets whatever order keys come in, and a Robin Hood table is
+*   those buckets with each run of filled buckets sorted by home bucket. Each thread finds the runs
+*   that start in its slice of the table, then once every thread has found its runs each sorts its
+*   own. A run may reach into the next slice, but runs never overlap.
+*
+* param :
+*   homes: the home bucket of the key in each filled bucket
+*   threadCount: the number of threads to use
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::sortRobinHoodClusters(const std::vector<size_t>& homes, size_t threadCount) {
+    size_t tableCapacity = this->tableData.size();
+    std::vector<std::vector<size_t>> runStarts(threadCount);
+    runParallel(threadCount, tableCapacity, [&](size_t begin, size_t end, size_t thread) {
+        for (size_t start = begin; start < end; start++) {
+            size_t previous = start == 0 ? tableCapacity - 1 : start - 1;
+            if (!this->tableData[start].isEmpty() and this->tableData[previous].isEmpty()) {
+                runStarts[thread].push_back(start);
+            }
+        }
+    });
+
+    runParallel(threadCount, tableCapacity, [&](size_t, size_t, size_t thread) {
+        std::vector<std::pair<size_t, Bucket>> run;
+        for (size_t start : runStarts[thread]) {
+            //Keys of a run all have their home inside it, so sort by distance from the run's start
+            run.clear();
+            for (size_t i = start; !this->tableData[i].isEmpty(); i = i + 1 < tableCapacity ? i + 1 : 0) {
+                run.emplace_back((homes[i] + tableCapacity - start) % tableCapacity, std::move(this->tableData[i]));
+            }
+            std::sort(run.begin(), run.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            size_t vectorIndex = start;
+            for (size_t r = 0; r < run.size(); r++) {
+                this->tableData[vectorIndex] = std::move(run[r].second);
+                this->tableData[vectorIndex].setDistance(static_cast<uint32_t>(r - run[r].first));
+                vectorIndex = vectorIndex + 1 < tableCapacity ? vectorIndex + 1 : 0;
+            }
+        }
+    });
+}
+
+/**
+* startMigration: begin an incremental resize. The current vector table becomes the old table and
+*   a new empty one of the given capacity takes its place, buckets are then moved over by
+*   migrateBuckets. Each operation moves enough buckets that the old table is empty before inserts
+*   can reach the next resize, even with a small growth factor.
+*
+* param :
+*   newCapacity: the number of buckets the new table should have
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::startMigration(size_t newCapacity) {
+    //Only one old table is kept, so a resize still running has to finish first. Growth needs
+    //capacity/2 inserts which move far more than capacity buckets, so this is normally a no-op
+    this->migrateBuckets(this->oldTableData.size());
+
+    newCapacity = this->fitCapacity(newCapacity);
+    //A migration at the same capacity is compactIfNeeded's cleanup, which counts itself
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        this->counters.resizeCount += newCapacity != this->capacity();
+    }
+
+    this->oldTableData = std::move(this->tableData);
+    this->oldKeyArena = std::move(this->keyArena);
+    this->tableData.clear();
+    this->tableData.resize(newCapacity);
+    this->numCapacity = newCapacity;
+    this->migrateIndex = 0;
+    this->removedKeyBytes = 0;
+    this->numRemoved = 0;
+    //bloom keeps answering for both tables while its replacement is filled as buckets move
+    if (this->bloomFilter) {
+        this->nextBloom.reset(this->bloomKeyCount());
+    }
+
+    size_t oldCapacity = this->oldTableData.size();
+    size_t maxSize = static_cast<size_t>(this->maxLoadFactor * static_cast<double>(newCapacity));
+    size_t insertsUntilResize = std::max<size_t>(maxSize > this->numSize ? maxSize - this->numSize : 0, 1);
+    this->migrateStep = std::max(MIGRATE_BUCKETS_PER_OP, oldCapacity / insertsUntilResize + 1);
+}
+
+/**
+* migrateBuckets: move up to count buckets from the old vector table into the current one. Moved
+*   buckets are marked empty after removal so probe chains through them in the old table still work.
+*   Keys are copied into the current arena as they move. Once every bucket has been visited the old
+*   table and its arena are released.
+*
+* param :
+*   count: the most old buckets to visit
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::migrateBuckets(size_t count) {
+    if (!this->isResizing()) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    size_t stop = std::min(this->migrateIndex + count, this->oldTableData.size());
+    size_t probes = 0;
+    for (; this->migrateIndex < stop; this->migrateIndex++) {
+        Bucket& bucket = this->oldTableData[this->migrateIndex];
+        if (!bucket.isEmpty()) {
+            size_t hashValue = hash(bucket.getKey());
+            this->placeBucket(this->tableData, this->keyArena.store(bucket.getKey()), hashValue, std::move(bucket.getValueRef()), probes);
+            bucket.setBucketType(BucketType::EAR);
+            if (this->bloomFilter) {
+                this->nextBloom.add(this->seededMix(hashValue));
+            }
+        }
+    }
+
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        this->counters.resizeTime += std::chrono::steady_clock::now() - start;
+    }
+
+    if (this->migrateIndex == this->oldTableData.size()) {
+        BucketVector(this->oldTableData.get_allocator()).swap(this->oldTableData);
+        this->oldKeyArena.clear();
+        this->migrateIndex = 0;
+        if (this->bloomFilter) {
+            std::swap(this->bloom, this->nextBloom);
+            this->nextBloom.clear();
+            //Removes during the migration are not counted against the new filter, which is rebuilt once it fills anyway
+            this->bloomStale = 0;
+        }
+    }
+}
+
+/**
+* restoreKeys: copy the key of every filled bucket into this table's arena and point the bucket at
+*   the copy. Empty buckets drop their key since it may point into an arena that is going away.
+*   Tables whose keys are not arena backed have nothing to restore.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::restoreKeys() {
+    if constexpr (!Storage::USES_ARENA) {
+        return;
+    }
+    for (BucketVector* table : {&this->tableData, &this->oldTableData}) {
+        for (Bucket& bucket : *table) {
+            if (!bucket.isEmpty()) {
+                bool referenced = bucket.isReferenced();
+                bucket.load(this->keyArena.store(bucket.getKey()), bucket.getValue());
+                bucket.setReferenced(referenced);
+            }
+            else {
+                BucketType type = bucket.isEmptySinceStart() ? BucketType::ESS : BucketType::EAR;
+                bucket.load(typename Storage::Stored(), Value());
+                bucket.setBucketType(type);
+            }
+        }
+    }
+}
+
+/**
+* compactIfNeeded: clean up after removes once they pile up. If empty after remove buckets take up
+*   more than half of the buckets the max load factor leaves free (a quarter of the table at the
+*   default .5) they are cleared with an in place rehash, and if more than half of the key
+*   arena is removed keys the live keys are copied into a fresh arena. Both walk the whole table, so
+*   in incremental mode they are done by a migration into a new table of the same capacity instead,
+*   which moves a bounded slice per operation like a resize. Caches and cuckoo tables never migrate
+*   and clean up in place. Nothing is done mid resize, the resize clears both anyway.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::compactIfNeeded() {
+    if (this->isResizing()) {
+        return;
+    }
+
+    double maxRemovedLoad = (1.0 - this->maxLoadFactor) / 2;
+    bool tooManyRemoved = static_cast<double>(this->numRemoved) > maxRemovedLoad * static_cast<double>(this->capacity());
+    bool arenaWasted = this->removedKeyBytes > KeyArena::SLAB_SIZE and this->removedKeyBytes > this->keyArena.bytesUsed() / 2;
+    if ((tooManyRemoved or arenaWasted) and this->compactsByMigrating()) {
+        this->startCompaction();
+        return;
+    }
+
+    if (tooManyRemoved) {
+        this->rehashInPlace();
+    }
+
+    if (arenaWasted) {
+        [[maybe_unused]] typename Storage::Arena oldArena = std::move(this->keyArena);
+        this->restoreKeys();
+        this->removedKeyBytes = 0;
+    }
+}
+
+/**
+* compactsByMigrating: check if whole table cleanups run as a same capacity migration instead of in
+*   one go. Only incremental tables do, caches and cuckoo tables never migrate.
+*
+* returns:
+*   bool: true if cleanups should call startCompaction
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::compactsByMigrating() const {
+    return this->incrementalResize and !this->cuckoo and this->cacheEntries == 0;
+}
+
+/**
+* startCompaction: start a migration into a new table of the same capacity. Moving the buckets drops
+*   empty after remove buckets, copies the keys into a fresh arena and fills a fresh Bloom filter.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::startCompaction() {
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        this->counters.inPlaceRehashCount++;
+    }
+    this->startMigration(this->capacity());
+}
+
+/**
+* rehashInPlace: clear every empty after remove bucket without allocating a new vector table. Removed
+*   buckets become empty since start and filled ones are temporarily marked empty after remove to
+*   mean "not placed yet". Each unplaced key then moves to the first bucket of its probe sequence that
+*   is not already placed, swapping with another unplaced key if needed, until every key is placed.
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::rehashInPlace() {
+    size_t tableCapacity = this->tableData.size();
+    for (Bucket& bucket : this->tableData) {
+        if (bucket.isEmptySinceStart()) {
+            continue;
+        }
+        bucket.setBucketType(bucket.isEmpty() ? BucketType::ESS : BucketType::EAR);
+    }
+    //Every key is hashed once below, which is all a rebuild of the Bloom filter needs
+    if (this->bloomFilter) {
+        this->bloom.reset(this->bloomKeyCount());
+        this->bloomStale = 0;
+    }
+
+    for (size_t i = 0; i < tableCapacity; i++) {
+        //A swap can bring a different unplaced key into bucket i, so keep going until it is settled
+        while (this->tableData[i].isEmpty() and !this->tableData[i].isEmptySinceStart()) {
+            size_t hashValue = hash(this->tableData[i].getKey());
+            if (this->bloomFilter) {
+                this->bloom.add(this->seededMix(hashValue));
+            }
+            size_t step = probeStep(hashValue, tableCapacity);
+            size_t vectorIndex = this->homeIndex(hashValue, tableCapacity);
+            //Skip over buckets that already hold a placed key
+            while (!this->tableData[vectorIndex].isEmpty()) {
+                vectorIndex += step;
+                if (vectorIndex >= tableCapacity) {
+                    vectorIndex -= tableCapacity;
+                }
+            }
+
+            if (vectorIndex == i) {
+                this->tableData[i].setBucketType(BucketType::NORMAL);
+            }
+            else if (this->tableData[vectorIndex].isEmptySinceStart()) {
+                this->tableData[vectorIndex] = std::move(this->tableData[i]);
+                this->tableData[vectorIndex].setBucketType(BucketType::NORMAL);
+                this->tableData[i].setBucketType(BucketType::ESS);
+            }
+            else {
+                std::swap(this->tableData[i], this->tableData[vectorIndex]);
+                this->tableData[vectorIndex].setBucketType(BucketType::NORMAL);
+            }
+        }
+    }
+    this->numRemoved = 0;
+
+    if constexpr (HASHTABLE_STATS_ENABLED) {
+        this->counters.inPlaceRehashCount++;
+    }
+}
+
+/**
+* writeTable: write one vector table to a snapshot, in the layout described at save()
+*
+* param :
+*   out: the snapshot being written
+*   table: the vector table to write
+*
+* returns:
+*   bool: true if every write went through
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::writeTable(std::ostream& out, const BucketVector& table) const {
+    uint64_t blobBytes = 0;
+    if constexpr (Storage::USES_ARENA) {
+        for (const Bucket& bucket : table) {
+            blobBytes += bucket.isEmpty() ? 0 : Storage::keyBytes(bucket.getKey());
+        }
+    }
+    uint64_t sizes[2] = {table.size(), blobBytes};
+    out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    if constexpr (Storage::USES_ARENA) {
+        for (const Bucket& bucket : table) {
+            if (!bucket.isEmpty()) {
+                out.write(bucket.getKey().data(), static_cast<std::streamsize>(bucket.getKey().size()));
+            }
+        }
+    }
+
+    std::vector<uint8_t> types;
+    std::vector<uint32_t> distances;
+    std::vector<uint64_t> keyEnds;
+    std::vector<typename Storage::Stored> keys;
+    std::vector<Value> values;
+    uint64_t keyEnd = 0;
+    for (size_t start = 0; start < table.size() and out; start += SNAPSHOT_CHUNK) {
+        size_t count = std::min(SNAPSHOT_CHUNK, table.size() - start);
+        types.clear();
+        distances.clear();
+        keyEnds.clear();
+        keys.clear();
+        values.clear();
+        for (size_t i = start; i < start + count; i++) {
+            const Bucket& bucket = table[i];
+            types.push_back(static_cast<uint8_t>(bucket.isEmptySinceStart() ? BucketType::ESS : bucket.isEmpty() ? BucketType::EAR : BucketType::NORMAL));
+            distances.push_back(bucket.getDistance());
+            if constexpr (Storage::USES_ARENA) {
+                keyEnd += bucket.isEmpty() ? 0 : Storage::keyBytes(bucket.getKey());
+                keyEnds.push_back(keyEnd);
+            }
+            else {
+                keys.push_back(bucket.isEmpty() ? typename Storage::Stored() : bucket.getKey());
+            }
+            values.push_back(bucket.isEmpty() ? Value() : bucket.getValueRef());
+        }
+        out.write(reinterpret_cast<const char*>(types.data()), static_cast<std::streamsize>(count * sizeof(uint8_t)));
+        out.write(reinterpret_cast<const char*>(distances.data()), static_cast<std::streamsize>(count * sizeof(uint32_t)));
+        if constexpr (Storage::USES_ARENA) {
+            out.write(reinterpret_cast<const char*>(keyEnds.data()), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+        }
+        else {
+            out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(count * sizeof(Key)));
+        }
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(count * sizeof(Value)));
+    }
+    return out.good();
+}
+
+/**
+* readTable: read one vector table written by writeTable. The key blob is read straight into a single
+*   arena block and every bucket points into it. Bucket types and key ends are checked so a damaged
+*   file cannot make a bucket point outside the blob.
+*
+* param :
+*   in: the snapshot being read
+*   table: replaced by the vector table read
+*   arena: the arena the table's keys go into
+*   filled: has the number of filled buckets read added to it
+*
+* returns:
+*   bool: true if the vector table was read and is consistent
+*/
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<Key, Value, Hash, KeyEqual, Allocator>::readTable(std::istream& in, BucketVector& table,
+                                                                      typename Storage::Arena& arena, size_t& filled) {
+    uint64_t sizes[2];
+    if (!in.read(reinterpret_cast<char*>(sizes), sizeof(sizes))) {
+        return false;
+    }
+    uint64_t bucketCount = sizes[0];
+    uint64_t blobBytes = sizes[1];
+
+    //Check the sizes against what is left of the file before allocating anything for them
+    std::istream::pos_type position = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t remaining = static_cast<uint64_t>(in.tellg() - position);
+    in.seekg(position);
+    uint64_t bucketBytes = sizeof(uint8_t) + sizeof(uint32_t) + (Storage::USES_ARENA ? sizeof(uint64_t) : sizeof(Key)) + sizeof(Value);
+    if (!in or blobBytes > remaining or bucketCount > (remaining - blobBytes) / bucketBytes or (!Storage::USES_ARENA and blobBytes != 0)) {
+        return false;
+    }
+
+    const char* blob = nullptr;
+    if constexpr (Storage::USES_ARENA) {
+        if (blobBytes > 0) {
+            char* block = arena.allocateBlock(blobBytes);
+            if (!in.read(block, static_cast<std::streamsize>(blobBytes))) {
+                return false;
+            }
+            blob = block;
+        }
+    }
+
+    table.clear();
+    table.resize(bucketCount);
+    size_t chunk = std::min<size_t>(SNAPSHOT_CHUNK, bucketCount);
+    std::vector<uint8_t> types(chunk);
+    std::vector<uint32_t> distances(chunk);
+    std::vector<uint64_t> keyEnds(Storage::USES_ARENA ? chunk : 0);
+    std::vector<typename Storage::Stored> keys(Storage::USES_ARENA ? 0 : chunk);
+    std::vector<Value> values(chunk);
+    uint64_t keyStart = 0;
+    for (size_t start = 0; start < bucketCount; start += chunk) {
+        size_t count = std::min<size_t>(chunk, bucketCount - start);
+        in.read(reinterpret_cast<char*>(types.data()), static_cast<std::streamsize>(count * sizeof(uint8_t)));
+        in.read(reinterpret_cast<char*>(distances.data()), static_cast<std::streamsize>(count * sizeof(uint32_t)));
+        if constexpr (Storage::USES_ARENA) {
+            in.read(reinterpret_cast<char*>(keyEnds.data()), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+        }
+        else {
+            in.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(count * sizeof(Key)));
+        }
+        in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(Value)));
+        if (!in) {
+            return false;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            Bucket& bucket = table[start + i];
+            BucketType type = static_cast<BucketType>(types[i]);
+            if (type != BucketType::NORMAL and type != BucketType::ESS and type != BucketType::EAR) {
+                return false;
+            }
+            if constexpr (Storage::USES_ARENA) {
+                if (keyEnds[i] < keyStart or keyEnds[i] > blobBytes or (type != BucketType::NORMAL and keyEnds[i] != keyStart)) {
+                    return false;
+                }
+                if (type == BucketType::NORMAL) {
+                    bucket.load(typename Storage::Stored(blob + keyStart, keyEnds[i] - keyStart), values[i]);
+                }
+                keyStart = keyEnds[i];
+            }
+            else if (type == BucketType::NORMAL) {
+                bucket.load(keys[i], values[i]);
+            }
+            bucket.setBucketType(type);
+            bucket.setDistance(distances[i]);
+            filled += type == BucketType::NORMAL;
+        }
+    }
+    return keyStart == blobBytes;
+}
+
+//The string table is compiled once in HashTable.cpp instead of in every file that uses it
+extern template class BasicHashTableBucket<std::string_view, size_t>;
+extern template class BasicHashTable<std::string, size_t>;
+
+//FlatIntegerHashTable, a flat array layout for uint32_t and uint64_t keys instead of the bucket one above
+#include "FlatIntegerHashTable.h"
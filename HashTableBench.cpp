@@ -0,0 +1,672 @@
+/**
+ * HashTableBench.cpp
+ *
+ * Runs a set of standard workloads against HashTable, SwissHashTable and std::unordered_map and
+ * prints ns/op, ops/sec and bytes/entry for each so changes to the table can be compared. Inserts
+ * into ConcurrentHashTable are also timed with a growing number of threads. ns/op there is wall
+ * time over all threads' ops, so it should drop as threads are added. Lookups with one writer running
+ * alongside compare the shard locks of ConcurrentHashTable with the lock-free reads of
+ * OptimisticHashTable. The cost of each hash function is timed first, for a range of key lengths.
+ *
+ * usage: HashTableBench [maxSize]
+ *      Table sizes go from 1K up by powers of ten to maxSize (default 1M, up to 100M).
+ *      Build with -DCMAKE_BUILD_TYPE=Release or the numbers mean nothing.
+ */
+#include "HashTable.h"
+#include "SwissHashTable.h"
+#include "ConcurrentHashTable.h"
+#include "OptimisticHashTable.h"
+#include "FrozenHashTable.h"
+#include "HugePageResource.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+//Every allocation goes through these so the bench can tell how many bytes a table holds
+static atomic<size_t> liveBytes{0};
+
+void* operator new(size_t size) {
+    void* block = malloc(size + alignof(max_align_t));
+    if (block == nullptr) {
+        throw bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    liveBytes.fetch_add(size, memory_order_relaxed);
+    return static_cast<char*>(block) + alignof(max_align_t);
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        void* block = static_cast<char*>(pointer) - alignof(max_align_t);
+        liveBytes.fetch_sub(*static_cast<size_t*>(block), memory_order_relaxed);
+        free(block);
+    }
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete[](void* pointer) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    ::operator delete(pointer);
+}
+
+//Keep results alive so the optimizer cannot drop the lookups being timed
+static volatile size_t sink;
+
+/**
+* Adapters: the same small set of operations for each table type so every workload is one template
+*/
+static void tableInsert(HashTable& table, const string& key, size_t value) { table.insert(key, value); }
+static bool tableFind(const HashTable& table, const string& key) { return table.contains(key); }
+static void tableRemove(HashTable& table, const string& key) { table.remove(key); }
+static size_t tableScan(const HashTable& table) {
+    size_t sum = 0;
+    for (const auto& [key, value] : table) {
+        sum += value;
+    }
+    return sum;
+}
+
+//HashTable with Robin Hood probing from the start, it uses the HashTable adapters above
+struct RobinHoodHashTable : HashTable {
+    RobinHoodHashTable() { this->setRobinHood(true); }
+};
+
+//HashTable in cuckoo mode, filled to .9 since that is what the mode is for
+struct CuckooHashTable : HashTable {
+    CuckooHashTable() {
+        this->setCuckoo(true);
+        this->setMaxLoadFactor(0.9);
+    }
+};
+
+//HashTable with its Bloom filter on, so misses mostly stop at the filter
+struct BloomHashTable : HashTable {
+    BloomHashTable() { this->setBloomFilter(true); }
+};
+
+static void tableInsert(SwissHashTable& table, const string& key, size_t value) { table.insert(key, value); }
+static bool tableFind(const SwissHashTable& table, const string& key) { return table.contains(key); }
+static void tableRemove(SwissHashTable& table, const string& key) { table.remove(key); }
+//SwissHashTable has no iterators so its scan has to go through keys()
+static size_t tableScan(const SwissHashTable& table) {
+    size_t sum = 0;
+    for (const string& key : table.keys()) {
+        sum += key.size();
+    }
+    return sum;
+}
+
+using StdMap = unordered_map<string, size_t>;
+static void tableInsert(StdMap& table, const string& key, size_t value) { table.emplace(key, value); }
+static bool tableFind(const StdMap& table, const string& key) { return table.find(key) != table.end(); }
+static void tableRemove(StdMap& table, const string& key) { table.erase(key); }
+static size_t tableScan(const StdMap& table) {
+    size_t sum = 0;
+    for (const auto& [key, value] : table) {
+        sum += value;
+    }
+    return sum;
+}
+
+/**
+* ZipfianGenerator: draws ranks in [0, count) where rank r has probability proportional to 1/(r+1)^theta.
+*   Uses the closed form from Gray et al., "Quickly Generating Billion-Record Synthetic Databases", the
+*   same generator YCSB uses for its skewed workloads.
+*/
+class ZipfianGenerator {
+    private:
+        size_t count;
+        double theta;
+        double alpha;
+        double zetaN;
+        double eta;
+
+        static double zeta(size_t count, double theta) {
+            double sum = 0;
+            for (size_t i = 1; i <= count; i++) {
+                sum += 1.0 / pow(static_cast<double>(i), theta);
+            }
+            return sum;
+        }
+
+    public:
+        ZipfianGenerator(size_t count, double theta = 0.99) : count(count), theta(theta) {
+            this->zetaN = zeta(count, theta);
+            this->alpha = 1.0 / (1.0 - theta);
+            this->eta = (1.0 - pow(2.0 / static_cast<double>(count), 1.0 - theta)) / (1.0 - zeta(2, theta) / this->zetaN);
+        }
+
+        size_t next(mt19937_64& random) {
+            double u = uniform_real_distribution<double>(0.0, 1.0)(random);
+            double uz = u * this->zetaN;
+            if (uz < 1.0) {
+                return 0;
+            }
+            if (uz < 1.0 + pow(0.5, this->theta)) {
+                return 1;
+            }
+            size_t rank = static_cast<size_t>(static_cast<double>(this->count) * pow(this->eta * u - this->eta + 1.0, this->alpha));
+            return min(rank, this->count - 1);
+        }
+};
+
+/**
+* Workload inputs shared by every table type at one size, generated before anything is timed
+*/
+struct Workload {
+    vector<string> keys;
+    vector<string> missingKeys;
+    vector<string> churnKeys;
+    vector<size_t> zipfianOrder;
+};
+
+/**
+* printResult: print one row of the results table
+*/
+static void printResult(const string& workload, size_t size, const string& tableName, double nanoseconds, size_t ops,
+                        double bytesPerEntry) {
+    double nsPerOp = nanoseconds / static_cast<double>(ops);
+    cout << left << setw(12) << workload << right << setw(11) << size << "  " << left << setw(16) << tableName
+         << right << fixed << setprecision(1) << setw(10) << nsPerOp << setw(12) << setprecision(2) << 1000.0 / nsPerOp;
+    if (bytesPerEntry > 0) {
+        cout << setw(14) << setprecision(1) << bytesPerEntry;
+    }
+    cout << endl;
+}
+
+template <typename Function>
+static double timeNanoseconds(Function&& function) {
+    auto start = chrono::steady_clock::now();
+    function();
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+* runWorkloads: run every workload against one table type. The table built by the insert workload
+*   is reused by the read workloads, and churn runs last since it changes the table.
+*/
+template <typename Table>
+static void runWorkloads(const string& tableName, const Workload& workload) {
+    size_t size = workload.keys.size();
+    size_t bytesBefore = liveBytes.load();
+    Table* table = new Table();
+
+    double nanoseconds = timeNanoseconds([&] {
+        for (size_t i = 0; i < size; i++) {
+            tableInsert(*table, workload.keys[i], i);
+        }
+    });
+    double bytesPerEntry = static_cast<double>(liveBytes.load() - bytesBefore) / static_cast<double>(size);
+    printResult("insert", size, tableName, nanoseconds, size, bytesPerEntry);
+
+    nanoseconds = timeNanoseconds([&] {
+        size_t found = 0;
+        for (size_t index : workload.zipfianOrder) {
+            found += tableFind(*table, workload.keys[index]);
+        }
+        sink = found;
+    });
+    printResult("zipf-read", size, tableName, nanoseconds, workload.zipfianOrder.size(), 0);
+
+    nanoseconds = timeNanoseconds([&] {
+        size_t found = 0;
+        for (const string& key : workload.missingKeys) {
+            found += tableFind(*table, key);
+        }
+        sink = found;
+    });
+    printResult("miss", size, tableName, nanoseconds, workload.missingKeys.size(), 0);
+
+    nanoseconds = timeNanoseconds([&] {
+        sink = tableScan(*table);
+    });
+    printResult("scan", size, tableName, nanoseconds, size, 0);
+
+    //Each churn op removes the oldest key and inserts a new one, so the size stays the same
+    nanoseconds = timeNanoseconds([&] {
+        for (size_t i = 0; i < workload.churnKeys.size(); i++) {
+            tableRemove(*table, i < size ? workload.keys[i] : workload.churnKeys[i - size]);
+            tableInsert(*table, workload.churnKeys[i], i);
+        }
+    });
+    printResult("churn", size, tableName, nanoseconds, workload.churnKeys.size(), 0);
+
+    delete table;
+}
+
+/**
+* runConcurrentInserts: time inserting every key into a ConcurrentHashTable with 1, 2, 4... threads up
+*   to the hardware thread count, each thread inserting its own slice of the keys
+*/
+static void runConcurrentInserts(const Workload& workload) {
+    size_t size = workload.keys.size();
+    size_t maxThreads = max<size_t>(thread::hardware_concurrency(), 1);
+    for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        ConcurrentHashTable table;
+        double nanoseconds = timeNanoseconds([&] {
+            vector<thread> threads;
+            for (size_t t = 0; t < threadCount; t++) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = t; i < size; i += threadCount) {
+                        table.insert(workload.keys[i], i);
+                    }
+                });
+            }
+            for (thread& worker : threads) {
+                worker.join();
+            }
+        });
+        printResult("mt-insert", size, "Concurrent x" + to_string(threadCount), nanoseconds, size, 0);
+    }
+}
+
+/**
+* runIntegerInserts: time inserting 64 bit IDs into a FlatIntegerHashTable keyed by uint64_t next to
+*   stringifying the same IDs into a HashTable, the conversion integer keys used to need
+*/
+static void runIntegerInserts(size_t size) {
+    size_t bytesBefore = liveBytes.load();
+    FlatIntegerHashTable<uint64_t, size_t>* idTable = new FlatIntegerHashTable<uint64_t, size_t>();
+    double nanoseconds = timeNanoseconds([&] {
+        for (size_t i = 0; i < size; i++) {
+            idTable->insert(i * 0x9e3779b97f4a7c15ULL, i);
+        }
+    });
+    printResult("insert-id", size, "BasicHashTable", nanoseconds, size,
+                static_cast<double>(liveBytes.load() - bytesBefore) / static_cast<double>(size));
+    delete idTable;
+
+    bytesBefore = liveBytes.load();
+    HashTable* stringTable = new HashTable();
+    nanoseconds = timeNanoseconds([&] {
+        for (size_t i = 0; i < size; i++) {
+            stringTable->insert(to_string(i * 0x9e3779b97f4a7c15ULL), i);
+        }
+    });
+    printResult("insert-id", size, "HashTable", nanoseconds, size,
+                static_cast<double>(liveBytes.load() - bytesBefore) / static_cast<double>(size));
+    delete stringTable;
+}
+
+/**
+* runSnapshotLoad: time loading a saved HashTable back from a snapshot file, next to the insert row
+*   above which is what rebuilding it key by key costs. The file is fresh in the page cache, so this
+*   is the cost of the load itself rather than of the disk.
+*/
+static void runSnapshotLoad(const Workload& workload) {
+    size_t size = workload.keys.size();
+    const string path = (filesystem::temp_directory_path() / "hashtable_bench_snapshot.bin").string();
+    {
+        HashTable table;
+        for (size_t i = 0; i < size; i++) {
+            table.insert(workload.keys[i], i);
+        }
+        if (!table.save(path)) {
+            cout << "could not write " << path << endl;
+            return;
+        }
+    }
+
+    HashTable* loaded = new HashTable();
+    double nanoseconds = timeNanoseconds([&] {
+        sink = loaded->load(path);
+    });
+    printResult("load", size, "HashTable", nanoseconds, size,
+                static_cast<double>(filesystem::file_size(path)) / static_cast<double>(size));
+    delete loaded;
+    filesystem::remove(path);
+}
+
+/**
+* runFrozenReads: time freezing a HashTable into a FrozenHashTable file, then the zipf-read lookups
+*   against the mapped file
+*/
+static void runFrozenReads(const Workload& workload) {
+    size_t size = workload.keys.size();
+    const string path = (filesystem::temp_directory_path() / "hashtable_bench_frozen.bin").string();
+    HashTable table;
+    for (size_t i = 0; i < size; i++) {
+        table.insert(workload.keys[i], i);
+    }
+    bool written = false;
+    double nanoseconds = timeNanoseconds([&] {
+        written = FrozenHashTable::write(table, path);
+    });
+    FrozenHashTable frozen;
+    if (!written or !frozen.open(path)) {
+        cout << "could not write " << path << endl;
+        return;
+    }
+    printResult("freeze", size, "FrozenHashTable", nanoseconds, size,
+                static_cast<double>(filesystem::file_size(path)) / static_cast<double>(size));
+
+    nanoseconds = timeNanoseconds([&] {
+        size_t found = 0;
+        for (size_t index : workload.zipfianOrder) {
+            found += frozen.contains(workload.keys[index]);
+        }
+        sink = found;
+    });
+    printResult("zipf-read", size, "FrozenHashTable", nanoseconds, workload.zipfianOrder.size(), 0);
+
+    nanoseconds = timeNanoseconds([&] {
+        size_t found = 0;
+        for (const string& key : workload.missingKeys) {
+            found += frozen.contains(key);
+        }
+        sink = found;
+    });
+    printResult("miss", size, "FrozenHashTable", nanoseconds, workload.missingKeys.size(), 0);
+    filesystem::remove(path);
+}
+
+/**
+* runRehash: time doubling the capacity of a full HashTable, the rehash a growing insert triggers,
+*   on one thread and split over every hardware thread
+*/
+static void runRehash(const Workload& workload) {
+    size_t size = workload.keys.size();
+    size_t maxThreads = max<size_t>(thread::hardware_concurrency(), 1);
+    for (size_t threadCount : {size_t(1), maxThreads}) {
+        HashTable table;
+        for (size_t i = 0; i < size; i++) {
+            table.insert(workload.keys[i], i);
+        }
+        table.setRehashThreads(threadCount);
+        double nanoseconds = timeNanoseconds([&] {
+            table.reserve(table.size() * 4);
+        });
+        printResult("rehash", size, "HashTable x" + to_string(threadCount), nanoseconds, size, 0);
+        if (maxThreads == 1) {
+            break;
+        }
+    }
+}
+
+/**
+* runBulkLoad: time building a HashTable from all the keys at once with bulkLoad, on one thread and
+*   split over every hardware thread, to compare with the insert row
+*/
+static void runBulkLoad(const Workload& workload) {
+    size_t size = workload.keys.size();
+    vector<pair<string_view, size_t>> pairs;
+    pairs.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        pairs.emplace_back(workload.keys[i], i);
+    }
+    size_t maxThreads = max<size_t>(thread::hardware_concurrency(), 1);
+    for (size_t threadCount : {size_t(1), maxThreads}) {
+        HashTable table;
+        table.setRehashThreads(threadCount);
+        double nanoseconds = timeNanoseconds([&] {
+            sink = table.bulkLoad(pairs);
+        });
+        printResult("bulk-load", size, "HashTable x" + to_string(threadCount), nanoseconds, size, 0);
+        if (maxThreads == 1) {
+            break;
+        }
+    }
+}
+
+/**
+* runHugePageReads: time lookups of every key in random order against a HashTable on the heap and a
+*   PmrHashTable whose buckets sit in 2MB pages from HugePageResource. With 4KB pages most random
+*   lookups in a table far past the TLB's reach (a few MB) also miss the TLB, which huge pages avoid.
+*   Huge page memory is mapped straight from the OS, so it has no bytes/entry.
+*/
+static void runHugePageReads(const Workload& workload, mt19937_64& random) {
+    size_t size = workload.keys.size();
+    vector<size_t> order(size);
+    for (size_t i = 0; i < size; i++) {
+        order[i] = i;
+    }
+    shuffle(order.begin(), order.end(), random);
+
+    auto timeReads = [&](const auto& table, const string& tableName) {
+        double nanoseconds = timeNanoseconds([&] {
+            size_t found = 0;
+            for (size_t index : order) {
+                found += table.contains(workload.keys[index]);
+            }
+            sink = found;
+        });
+        printResult("random-read", size, tableName, nanoseconds, size, 0);
+    };
+
+    {
+        HashTable table;
+        table.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            table.insert(workload.keys[i], i);
+        }
+        timeReads(table, "HashTable");
+    }
+    HugePageResource hugePages;
+    PmrHashTable table(HashTable::DEFAULT_INITIAL_CAPACITY, WyHash(), equal_to<>(), &hugePages);
+    table.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        table.insert(workload.keys[i], i);
+    }
+    timeReads(table, "HashTable 2MB");
+}
+
+/**
+* runBatchReads: time the zipf-read lookups through HashTable::containsBatch, which hashes and
+*   prefetches a window of keys before probing any of them, to compare against the one-at-a-time loop
+*/
+static void runBatchReads(const Workload& workload) {
+    size_t size = workload.keys.size();
+    HashTable table;
+    for (size_t i = 0; i < size; i++) {
+        table.insert(workload.keys[i], i);
+    }
+    vector<string_view> keys;
+    keys.reserve(workload.zipfianOrder.size());
+    for (size_t index : workload.zipfianOrder) {
+        keys.emplace_back(workload.keys[index]);
+    }
+    unique_ptr<bool[]> found(new bool[keys.size()]);
+
+    double nanoseconds = timeNanoseconds([&] {
+        sink = table.containsBatch(keys, span<bool>(found.get(), keys.size()));
+    });
+    printResult("batch-read", size, "HashTable", nanoseconds, keys.size(), 0);
+}
+
+/**
+* runCacheReads: time the zipf-read keys against a HashTable cache holding a tenth of them, inserting
+*   each key that misses as a cache in front of a slower store would. bytes/entry is what the cache
+*   holds at the end, per cached key.
+*/
+static void runCacheReads(const Workload& workload) {
+    size_t size = workload.keys.size();
+    size_t entries = max<size_t>(size / 10, 1);
+    size_t bytesBefore = liveBytes.load();
+    HashTable cache;
+    cache.setCacheCapacity(entries);
+
+    double nanoseconds = timeNanoseconds([&] {
+        for (size_t index : workload.zipfianOrder) {
+            if (!cache.get(workload.keys[index])) {
+                cache.insert(workload.keys[index], index);
+            }
+        }
+    });
+    double bytesPerEntry = static_cast<double>(liveBytes.load() - bytesBefore) / static_cast<double>(entries);
+    printResult("cache-read", size, "HashTable 10%", nanoseconds, workload.zipfianOrder.size(), bytesPerEntry);
+}
+
+/**
+* runConcurrentReads: time Zipfian lookups split over 1, 2, 4... reader threads while one writer keeps
+*   inserting and removing churn keys. Only the readers are timed.
+*/
+template <typename Table>
+static void runConcurrentReads(const string& tableName, const Workload& workload) {
+    size_t size = workload.keys.size();
+    size_t ops = workload.zipfianOrder.size();
+    size_t maxThreads = max<size_t>(thread::hardware_concurrency(), 1);
+    for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        Table table;
+        for (size_t i = 0; i < size; i++) {
+            table.insert(workload.keys[i], i);
+        }
+
+        atomic<bool> done{false};
+        thread writer([&] {
+            for (size_t i = 0; !done.load(memory_order_relaxed); i = (i + 1) % workload.churnKeys.size()) {
+                table.insert(workload.churnKeys[i], i);
+                table.remove(workload.churnKeys[i]);
+            }
+        });
+
+        double nanoseconds = timeNanoseconds([&] {
+            vector<thread> readers;
+            for (size_t t = 0; t < threadCount; t++) {
+                readers.emplace_back([&, t] {
+                    size_t found = 0;
+                    for (size_t i = t; i < ops; i += threadCount) {
+                        found += table.contains(workload.keys[workload.zipfianOrder[i]]);
+                    }
+                    sink = found;
+                });
+            }
+            for (thread& reader : readers) {
+                reader.join();
+            }
+        });
+        done = true;
+        writer.join();
+        printResult("mt-read", size, tableName + " x" + to_string(threadCount), nanoseconds, ops, 0);
+    }
+}
+
+/**
+* runHashCost: time one hash function over a set of keys that all have the same length. The size
+*   column is the key length in bytes here, not a table size.
+*/
+template <typename HashFunction>
+static void runHashCost(const string& hashName, HashFunction hashFunction, const vector<string>& keys, size_t length) {
+    const size_t rounds = 2000;
+    size_t total = 0;
+    double nanoseconds = timeNanoseconds([&] {
+        for (size_t round = 0; round < rounds; round++) {
+            for (const string& key : keys) {
+                total += hashFunction(string_view(key));
+            }
+        }
+    });
+    sink = total;
+    printResult("hash", length, hashName, nanoseconds, rounds * keys.size(), 0);
+}
+
+/**
+* runHashCosts: time std::hash, WyHash and SipHash over random keys of 4 bytes up to 1KB
+*/
+static void runHashCosts(mt19937_64& random) {
+    for (size_t length : {4, 8, 16, 32, 64, 256, 1024}) {
+        vector<string> keys(1000, string(length, ' '));
+        for (string& key : keys) {
+            for (char& byte : key) {
+                byte = static_cast<char>('a' + random() % 26);
+            }
+        }
+        runHashCost("std::hash", hash<string_view>(), keys, length);
+        runHashCost("WyHash", WyHash(), keys, length);
+        runHashCost("SipHash", SipHash(), keys, length);
+    }
+    cout << endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxSize = 1000000;
+    if (argc > 1) {
+        maxSize = stoull(argv[1]);
+    }
+
+#ifndef NDEBUG
+    cout << "warning: built without NDEBUG, configure with -DCMAKE_BUILD_TYPE=Release for real numbers" << endl << endl;
+#endif
+
+    cout << left << setw(12) << "workload" << right << setw(11) << "size" << "  " << left << setw(16) << "table"
+         << right << setw(10) << "ns/op" << setw(12) << "Mops/sec" << setw(14) << "bytes/entry" << endl;
+
+    mt19937_64 random(12345);
+    runHashCosts(random);
+    for (size_t size = 1000; size <= maxSize and size <= 100000000; size *= 10) {
+        //Lookup workloads run at least a million ops so small tables still give stable timings
+        size_t ops = max<size_t>(size, 1000000);
+        Workload workload;
+        workload.keys.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            workload.keys.push_back("key:" + to_string(i));
+        }
+        workload.missingKeys.reserve(ops);
+        for (size_t i = 0; i < ops; i++) {
+            workload.missingKeys.push_back("miss:" + to_string(i));
+        }
+        workload.churnKeys.reserve(ops);
+        for (size_t i = 0; i < ops; i++) {
+            workload.churnKeys.push_back("churn:" + to_string(i));
+        }
+
+        //Zipfian ranks are scattered over the key list so hot keys are not also neighbours in the table
+        ZipfianGenerator zipfian(size);
+        vector<size_t> rankToKey(size);
+        for (size_t i = 0; i < size; i++) {
+            rankToKey[i] = i;
+        }
+        shuffle(rankToKey.begin(), rankToKey.end(), random);
+        workload.zipfianOrder.reserve(ops);
+        for (size_t i = 0; i < ops; i++) {
+            workload.zipfianOrder.push_back(rankToKey[zipfian.next(random)]);
+        }
+
+        runWorkloads<HashTable>("HashTable", workload);
+        runWorkloads<RobinHoodHashTable>("HashTable RH", workload);
+        runWorkloads<CuckooHashTable>("HashTable CK", workload);
+        runWorkloads<BloomHashTable>("HashTable BF", workload);
+        runBatchReads(workload);
+        runCacheReads(workload);
+        runSnapshotLoad(workload);
+        runRehash(workload);
+        runBulkLoad(workload);
+        runHugePageReads(workload, random);
+        runFrozenReads(workload);
+        runIntegerInserts(size);
+        runWorkloads<SwissHashTable>("SwissHashTable", workload);
+        runWorkloads<StdMap>("unordered_map", workload);
+        runConcurrentInserts(workload);
+        runConcurrentReads<ConcurrentHashTable>("Concurrent", workload);
+        runConcurrentReads<OptimisticHashTable>("Optimistic", workload);
+        cout << endl;
+    }
+    return 0;
+}
@@ -3,9 +3,1474 @@
  *
  * Write your tests in this file
  */
+#include "HashTable.h"
+#include "SwissHashTable.h"
+#include "ConcurrentHashTable.h"
+#include "OptimisticHashTable.h"
+#include "FrozenHashTable.h"
+#include "HugePageResource.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static bool anyErrors = false;
+
+/**
+* check: print CORRECT or ERROR for a test result and remember if anything failed
+*
+* param :
+*   passed: the result of the test
+*   message: what was being tested
+*/
+static void check(bool passed, const string& message) {
+    if (passed) {
+        cout << "CORRECT: " << message << endl;
+    }
+    else {
+        cout << "*** ERROR: " << message << " ***" << endl;
+        anyErrors = true;
+    }
+}
+
+/**
+* testIncrementalResize: grow a table in incremental mode and make sure keys can be found in both
+*   the old and the new vector tables while buckets migrate
+*/
+static void testIncrementalResize() {
+    cout << "Testing incremental resize" << endl;
+    cout << "--------------------------" << endl;
+
+    HashTable ht;
+    ht.setIncrementalResize(true);
+    const size_t count = 10000;
+    bool sawResize = false;
+    bool allFound = true;
+
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+        sawResize |= ht.isResizing();
+        //Look up an earlier key which may still be sitting in the old table
+        std::optional<size_t> value = ht.get(to_string(i / 2));
+        allFound &= value.has_value() && static_cast<size_t>(value.value()) == i / 2;
+    }
+    check(sawResize, "table was mid resize during inserts");
+    check(allFound, "keys found while buckets were migrating");
+    check(ht.size() == count, "size counts keys in both tables");
+
+    bool removed = true;
+    for (size_t i = 0; i < count; i += 2) {
+        removed &= ht.remove(to_string(i));
+    }
+    bool lookups = true;
+    for (size_t i = 0; i < count; i++) {
+        lookups &= ht.contains(to_string(i)) == (i % 2 == 1);
+    }
+    check(removed && lookups, "remove works on migrated and unmigrated keys");
+
+    ht.setIncrementalResize(false);
+    check(!ht.isResizing() && ht.keys().size() == count / 2, "turning incremental mode off finishes the resize");
+    cout << endl;
+}
+
+/**
+* testSwissHashTable: run inserts, removes and lookups through the control byte layout, including
+*   enough removes to force rehashing away empty after remove buckets
+*/
+static void testSwissHashTable() {
+    cout << "Testing SwissHashTable" << endl;
+    cout << "----------------------" << endl;
+
+    SwissHashTable ht;
+    const size_t count = 5000;
+    bool inserted = true;
+    for (size_t i = 0; i < count; i++) {
+        inserted &= ht.insert(to_string(i), i);
+    }
+    check(inserted && ht.size() == count, "inserted all keys");
+    check(!ht.insert("7", 7), "duplicate insert returned false");
+
+    bool found = true;
+    for (size_t i = 0; i < count; i++) {
+        found &= ht.get(to_string(i)) == i;
+    }
+    check(found, "found every key");
+    check(!ht.contains(to_string(count + 5)), "missing key not found");
+
+    //Churn keys at a steady size so removed buckets pile up and get rehashed away
+    size_t capacityBefore = ht.capacity();
+    bool churned = true;
+    for (size_t i = 0; i < 20 * count; i++) {
+        churned &= ht.remove(to_string(i));
+        churned &= ht.insert(to_string(i + count), i + count);
+    }
+    check(churned && ht.size() == count, "remove and reinsert under churn");
+    check(ht.capacity() == capacityBefore, "churn did not grow the table");
+
+    ht["brand new"] = 42;
+    check(ht.get("brand new") == 42u && ht.size() == count + 1, "operator[] inserts missing keys");
+    cout << endl;
+}
+
+/**
+* testKeyArena: make sure keys stored in the table's arena survive resizes, churn and copies
+*/
+static void testKeyArena() {
+    cout << "Testing key arena storage" << endl;
+    cout << "-------------------------" << endl;
+
+    HashTable ht;
+    const size_t count = 2000;
+    const string prefix(40, 'k');
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(prefix + to_string(i), i);
+    }
+
+    //Remove and reinsert enough long keys that the arena has to compact at a steady size
+    bool churned = true;
+    for (size_t i = 0; i < 10 * count; i++) {
+        churned &= ht.remove(prefix + to_string(i));
+        churned &= ht.insert(prefix + to_string(i + count), i + count);
+    }
+    bool found = true;
+    for (size_t i = 10 * count; i < 11 * count; i++) {
+        found &= ht.get(prefix + to_string(i)) == static_cast<int>(i);
+    }
+    check(churned && found && ht.size() == count, "keys survive churn and compaction");
+
+    HashTable copy(ht);
+    ht.remove(prefix + to_string(10 * count));
+    ht = HashTable();
+    bool copied = copy.size() == count;
+    for (size_t i = 10 * count; i < 11 * count; i++) {
+        copied &= copy.contains(prefix + to_string(i));
+    }
+    check(copied, "copy keeps its own keys after the original is cleared");
+    cout << endl;
+}
+
+/**
+* testHeterogeneousLookup: look keys up through string_view and C strings and check the emplace
+*   and assign style inserts
+*/
+static void testHeterogeneousLookup() {
+    cout << "Testing string_view lookups and emplace" << endl;
+    cout << "---------------------------------------" << endl;
+
+    HashTable ht;
+    ht.insert("alpha", 1);
+    ht.insert(string("beta"), 2);
+
+    //Keys parsed out of a larger buffer are looked up without building a string
+    const char buffer[] = "alpha,beta,gamma";
+    string_view view(buffer);
+    check(ht.get(view.substr(0, 5)) == 1 && ht.contains(view.substr(6, 4)) && !ht.contains(view.substr(11)),
+          "lookups through string_view slices");
+
+    auto [value, inserted] = ht.try_emplace("alpha", 10);
+    check(!inserted && value == 1, "try_emplace leaves existing values alone");
+    auto [newValue, newInserted] = ht.try_emplace(view.substr(11), 3);
+    newValue++;
+    check(newInserted && ht.get("gamma") == 4, "try_emplace inserts and returns the new value");
+
+    check(!ht.insert_or_assign("beta", 20) && ht.get("beta") == 20, "insert_or_assign replaces values");
+    check(ht.insert_or_assign("delta", 5) && ht.size() == 4, "insert_or_assign inserts missing keys");
+
+    ht["epsilon"] += 7;
+    check(ht.get("epsilon") == 7, "operator[] inserts missing keys with 0");
+    cout << endl;
+}
+
+/**
+* testIterators: walk the table with range based for loops, including while an incremental resize
+*   has keys split across both vector tables
+*/
+static void testIterators() {
+    cout << "Testing iterators" << endl;
+    cout << "-----------------" << endl;
+
+    HashTable empty;
+    check(empty.begin() == empty.end(), "empty table has begin == end");
+
+    HashTable ht;
+    ht.setIncrementalResize(true);
+    const size_t count = 1000;
+    size_t expectedSum = 0;
+    bool sawOldTable = false;
+    bool visitedAll = true;
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+        expectedSum += i;
+
+        //While migrating make sure a full walk sees every key, including ones not migrated yet
+        if (ht.isResizing()) {
+            size_t visited = 0;
+            for (HashTable::const_iterator it = ht.cbegin(); it != ht.cend(); ++it) {
+                sawOldTable |= it.inOldTable();
+                visited++;
+            }
+            visitedAll &= visited == ht.size();
+        }
+    }
+    check(visitedAll && sawOldTable, "iteration visits keys in both tables mid resize");
+
+    size_t sum = 0;
+    for (const auto& [key, value] : ht) {
+        sum += value;
+        visitedAll &= to_string(value) == key;
+    }
+    check(visitedAll && sum == expectedSum, "range for gives matching key and value");
+
+    for (auto [key, value] : ht) {
+        value *= 2;
+    }
+    check(ht.get("21") == 42, "values can be set through iterators");
+    cout << endl;
+}
+
+/**
+* testRemovedCompaction: churn keys at a steady size and make sure empty after remove buckets are
+*   cleared in place instead of piling up
+*/
+static void testRemovedCompaction() {
+    cout << "Testing empty after remove compaction" << endl;
+    cout << "-------------------------------------" << endl;
+
+    HashTable ht(4096);
+    const size_t count = 1500;
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+    }
+
+    bool bounded = true;
+    bool found = true;
+    for (size_t i = 0; i < 50 * count; i++) {
+        ht.remove(to_string(i));
+        ht.insert(to_string(i + count), i + count);
+        bounded &= ht.removedCount() <= ht.capacity() / 4;
+        found &= ht.contains(to_string(i + 1)) and !ht.contains(to_string(i));
+    }
+    check(bounded && ht.capacity() == 4096, "removed buckets stay under a quarter of the capacity");
+    check(found && ht.size() == count, "lookups stay correct across in place rehashes");
+
+    //Incremental tables clean up with a same size migration, in both probing modes, so no remove walks the whole table
+    for (bool robinHood : {false, true}) {
+        HashTable incremental(4096);
+        incremental.setIncrementalResize(true);
+        incremental.setRobinHood(robinHood);
+        for (size_t i = 0; i < count; i++) {
+            incremental.insert(to_string(i), i);
+        }
+        incremental.resetStats();
+        bool sawMigration = false;
+        found = true;
+        for (size_t i = 0; i < 50 * count; i++) {
+            incremental.remove(to_string(i));
+            incremental.insert(to_string(i + count), i + count);
+            sawMigration |= incremental.isResizing();
+            found &= incremental.contains(to_string(i + 1)) and !incremental.contains(to_string(i));
+        }
+        HashTableStats stats = incremental.stats();
+        check(sawMigration && found && incremental.capacity() == 4096 && incremental.size() == count &&
+                  (!HASHTABLE_STATS_ENABLED || (stats.resizeCount == 0 && stats.inPlaceRehashCount > 0)),
+              robinHood ? "incremental Robin Hood tables compact their arena by migrating"
+                        : "incremental tables clear removed buckets by migrating");
+    }
+    cout << endl;
+}
+
+/**
+* testSizingControls: check reserve, shrink_to_fit and the max load and growth factors
+*/
+static void testSizingControls() {
+    cout << "Testing reserve, shrink_to_fit and load factors" << endl;
+    cout << "-----------------------------------------------" << endl;
+
+    HashTable ht;
+    const size_t count = 10000;
+    ht.reserve(count);
+    size_t reserved = ht.capacity();
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+    }
+    check(reserved == ht.capacity() && ht.alpha() <= ht.getMaxLoadFactor(), "reserve avoids resizes");
+
+    for (size_t i = 100; i < count; i++) {
+        ht.remove(to_string(i));
+    }
+    ht.shrink_to_fit();
+    bool found = true;
+    for (size_t i = 0; i < 100; i++) {
+        found &= ht.get(to_string(i)) == static_cast<int>(i);
+    }
+    //Double hashing capacities are rounded up to powers of two, 200 buckets becomes 256
+    check(ht.capacity() == 256 && found, "shrink_to_fit gives back the unused buckets");
+
+    //A Robin Hood table takes any capacity, going back to double hashing rounds it up again
+    ht.setRobinHood(true);
+    ht.reserve(300);
+    size_t robinHoodCapacity = ht.capacity();
+    ht.setRobinHood(false);
+    for (size_t i = 0; i < 100; i++) {
+        found &= ht.get(to_string(i)) == static_cast<int>(i);
+    }
+    check(robinHoodCapacity == 600 && ht.capacity() == 1024 && found, "double hashing tables stay at powers of two");
+
+    check(!ht.setMaxLoadFactor(1.0) && !ht.setGrowthFactor(1.0), "out of range factors are rejected");
+    HashTable dense;
+    dense.setMaxLoadFactor(0.9);
+    dense.setGrowthFactor(1.5);
+    bool underMax = true;
+    for (size_t i = 0; i < count; i++) {
+        dense.insert(to_string(i), i);
+        underMax &= dense.alpha() <= 0.9;
+    }
+    check(underMax && dense.alpha() > 0.5 && dense.size() == count, "higher max load factor packs the table tighter");
+    cout << endl;
+}
+
+/**
+* testStats: check the probe histograms and resize counters line up with the operations done
+*/
+static void testStats() {
+    cout << "Testing stats" << endl;
+    cout << "-------------" << endl;
+
+    HashTable ht;
+    const size_t count = 1000;
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+    }
+    HashTableStats afterInserts = ht.stats();
+    size_t inserted = 0;
+    for (size_t length : afterInserts.insertProbeLengths) {
+        inserted += length;
+    }
+    check(!HASHTABLE_STATS_ENABLED || (inserted == count && afterInserts.resizeCount == 8),
+          "every insert and resize is counted");
+
+    ht.resetStats();
+    for (size_t i = 0; i < count; i++) {
+        ht.contains(to_string(i));
+        ht.contains("missing" + to_string(i));
+    }
+    ht.remove("5");
+    HashTableStats afterLookups = ht.stats();
+    size_t hits = 0;
+    size_t misses = 0;
+    for (size_t i = 0; i < HashTableStats::HISTOGRAM_BUCKETS; i++) {
+        hits += afterLookups.hitProbeLengths[i];
+        misses += afterLookups.missProbeLengths[i];
+    }
+    check(!HASHTABLE_STATS_ENABLED || (hits == count + 1 && misses == count && afterLookups.maxProbeLength >= 1),
+          "hits and misses are counted separately");
+    check(afterLookups.removedBuckets == 1, "removed buckets are reported");
+
+    //Const lookups from several threads share the counters, so none of their hits may be lost
+    ht.resetStats();
+    const HashTable& shared = ht;
+    const size_t threadCount = 4;
+    vector<thread> readers;
+    for (size_t t = 0; t < threadCount; t++) {
+        readers.emplace_back([&shared]() {
+            for (size_t i = 0; i < count; i++) {
+                shared.contains(to_string(i));
+            }
+        });
+    }
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    HashTableStats afterReaders = ht.stats();
+    size_t readerProbes = 0;
+    for (size_t i = 0; i < HashTableStats::HISTOGRAM_BUCKETS; i++) {
+        readerProbes += afterReaders.hitProbeLengths[i] + afterReaders.missProbeLengths[i];
+    }
+    check(!HASHTABLE_STATS_ENABLED || readerProbes == threadCount * count, "concurrent lookups are all counted");
+    cout << endl;
+}
+
+/**
+* testConcurrentHashTable: insert and remove from several threads at once, then check every shard
+*   ended up with the right keys
+*/
+static void testConcurrentHashTable() {
+    cout << "Testing ConcurrentHashTable" << endl;
+    cout << "---------------------------" << endl;
+
+    ConcurrentHashTable ht(8);
+    const size_t threadCount = 4;
+    const size_t perThread = 5000;
+    vector<thread> threads;
+    for (size_t t = 0; t < threadCount; t++) {
+        threads.emplace_back([&ht, t] {
+            for (size_t i = t * perThread; i < (t + 1) * perThread; i++) {
+                ht.insert(to_string(i), i);
+            }
+            //Remove every other key this thread inserted while the others are still writing
+            for (size_t i = t * perThread; i < (t + 1) * perThread; i += 2) {
+                ht.remove(to_string(i));
+            }
+        });
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    bool correct = ht.size() == threadCount * perThread / 2;
+    for (size_t i = 0; i < threadCount * perThread; i++) {
+        correct &= ht.contains(to_string(i)) == (i % 2 == 1);
+    }
+    check(correct, "concurrent inserts and removes leave the right keys");
+
+    vector<pair<string, size_t>> pairs;
+    for (size_t i = 0; i < 1000; i++) {
+        pairs.emplace_back("bulk" + to_string(i), i);
+    }
+    check(ht.insertBulk(pairs) == 1000 && ht.get("bulk500") == 500, "insertBulk inserts every pair");
+    check(ht.insertBulk(pairs) == 0, "insertBulk skips keys already in the table");
+
+    size_t shard = ht.shardFor("bulk7");
+    ht.withShard(shard, [](HashTable& table) { table["bulk7"] += 100; });
+    check(ht.get("bulk7") == 107, "withShard runs under the shard's lock");
+    check(ht.alpha() > 0 && ht.alpha() <= 0.5, "alpha is taken over every shard");
+
+    //The routing hash is the one the shard stores the key under
+    bool routed = true;
+    for (size_t i = 0; i < 100; i++) {
+        string key = "bulk" + to_string(i);
+        routed &= ht.withShard(ht.shardFor(key), [&](const HashTable& table) {
+            return table.hash(key) == ht.hash(key) && table.contains(key);
+        });
+    }
+    check(routed, "keys are routed by the hash their shard uses");
+
+    //Readers share a shard's lock, so they keep finding keys while a writer churns the same shards
+    atomic<bool> done{false};
+    atomic<size_t> wrongReads{0};
+    vector<thread> readers;
+    for (size_t t = 0; t < threadCount; t++) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                for (size_t i = 1; i < 1000; i += 2) {
+                    wrongReads += ht.get(to_string(i)) != i;
+                }
+            }
+        });
+    }
+    for (size_t i = 0; i < 20000; i++) {
+        ht.insert("churn" + to_string(i), i);
+        ht.remove("churn" + to_string(i / 2));
+    }
+    done = true;
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    check(wrongReads == 0, "shared readers never miss a key during writes");
+    cout << endl;
+}
+
+/**
+* testOptimisticHashTable: lock-free readers look keys up while one writer inserts, removes and grows
+*   the table underneath them, and never see a wrong value
+*/
+static void testOptimisticHashTable() {
+    cout << "Testing OptimisticHashTable" << endl;
+    cout << "---------------------------" << endl;
+
+    OptimisticHashTable ht(16);
+    check(ht.insert("one", 1) && !ht.insert("one", 2) && ht.get("one") == 1, "insert skips keys already in the table");
+    check(!ht.insert_or_assign("one", 3) && ht.get("one") == 3, "insert_or_assign replaces the value");
+    check(ht.remove("one") && !ht.contains("one") && !ht.remove("one"), "remove takes the key out");
+
+    //Stable keys are always present, churn keys come and go but always map to their own number
+    const size_t stableCount = 1000;
+    const size_t churnCount = 20000;
+    for (size_t i = 0; i < stableCount; i++) {
+        ht.insert("stable" + to_string(i), i);
+    }
+
+    atomic<bool> done{false};
+    atomic<size_t> wrongReads{0};
+    vector<thread> readers;
+    for (size_t t = 0; t < 4; t++) {
+        readers.emplace_back([&, t] {
+            size_t i = t;
+            while (!done.load()) {
+                if (ht.get("stable" + to_string(i % stableCount)) != i % stableCount) {
+                    wrongReads++;
+                }
+                optional<size_t> churn = ht.get("churn" + to_string(i % churnCount));
+                if (churn && *churn != i % churnCount) {
+                    wrongReads++;
+                }
+                i += 7;
+            }
+        });
+    }
+
+    for (size_t i = 0; i < churnCount; i++) {
+        ht.insert("churn" + to_string(i), i);
+        if (i % 3 == 0) {
+            ht.remove("churn" + to_string(i / 3));
+        }
+    }
+    done = true;
+    for (thread& reader : readers) {
+        reader.join();
+    }
+
+    check(wrongReads == 0, "readers never see a wrong value while the writer runs");
+    check(ht.size() == stableCount + churnCount - (churnCount + 2) / 3, "size counts every live key");
+    bool correct = true;
+    for (size_t i = 0; i < churnCount; i++) {
+        correct &= ht.contains("churn" + to_string(i)) == (i >= (churnCount + 2) / 3);
+    }
+    check(correct, "the writer's removes and inserts all landed");
+    check(ht.capacity() >= 2 * ht.size(), "the table grew to stay at most half full");
+    cout << endl;
+}
+
+/**
+* testBatchOperations: batch lookups and inserts give the same answers as the single key calls, both
+*   normally and in the middle of an incremental resize
+*/
+static void testBatchOperations() {
+    cout << "Testing batch operations" << endl;
+    cout << "------------------------" << endl;
+
+    const size_t count = 1000;
+    vector<string> names;
+    for (size_t i = 0; i < 2 * count; i++) {
+        names.push_back("batch" + to_string(i));
+    }
+    vector<pair<string_view, size_t>> pairs;
+    for (size_t i = 0; i < count; i++) {
+        pairs.emplace_back(names[i], i);
+    }
+    //The repeated key is only inserted once and keeps its first value
+    pairs.emplace_back(names[0], 99);
+
+    for (bool incremental : {false, true}) {
+        HashTable ht;
+        ht.setIncrementalResize(incremental);
+        string mode = incremental ? " (incremental resize)" : "";
+        check(ht.insertBatch(pairs) == count && ht.size() == count && ht.get(names[0]) == 0,
+              "insertBatch inserts each new key once" + mode);
+
+        //Half the keys are present and half are not
+        vector<string_view> keys(names.begin(), names.end());
+        vector<optional<size_t>> values(keys.size());
+        unique_ptr<bool[]> found(new bool[keys.size()]);
+        bool correct = ht.getBatch(keys, values) == count;
+        correct &= ht.containsBatch(keys, span<bool>(found.get(), keys.size())) == count;
+        for (size_t i = 0; i < keys.size(); i++) {
+            correct &= values[i] == (i < count ? optional<size_t>(i) : nullopt);
+            correct &= found[i] == (i < count);
+        }
+        check(correct, "getBatch and containsBatch match get and contains" + mode);
+
+        vector<optional<size_t>> shortResults(10);
+        check(ht.getBatch(keys, shortResults) == 10 && shortResults[9] == 9, "getBatch stops at the end of results" + mode);
+    }
+    cout << endl;
+}
+
+/**
+* testGenericKeys: integer and struct keys are stored without any conversion, and values wider than
+*   an int come back whole
+*/
+struct Point {
+    int x;
+    int y;
+
+    bool operator==(const Point& other) const = default;
+};
+
+struct PointHash {
+    size_t operator()(const Point& point) const {
+        return hash<long long>{}((static_cast<long long>(point.x) << 32) ^ static_cast<unsigned>(point.y));
+    }
+};
+
+static void testGenericKeys() {
+    cout << "Testing generic keys" << endl;
+    cout << "--------------------" << endl;
+
+    BasicHashTable<uint64_t, uint64_t> ids;
+    const uint64_t big = uint64_t(1) << 40;
+    for (uint64_t i = 0; i < 1000; i++) {
+        ids.insert(big + i, big * 2 + i);
+    }
+    check(ids.get(big + 500) == big * 2 + 500, "get returns 64 bit values without truncating");
+    check(ids.size() == 1000 && !ids.contains(500), "integer keys are found by value");
+
+    for (uint64_t i = 0; i < 1000; i += 2) {
+        ids.remove(big + i);
+    }
+    ids[big + 1] += 1;
+    bool correct = ids.size() == 500 && ids.get(big + 1) == big * 2 + 2;
+    for (uint64_t i = 3; i < 1000; i += 2) {
+        correct &= ids.get(big + i) == big * 2 + i;
+    }
+    check(correct, "removes and operator[] work on integer keys");
+
+    BasicHashTable<Point, string, PointHash> points;
+    points.insert({1, 2}, "a");
+    points.insert({2, 1}, "b");
+    check(!points.insert({1, 2}, "c") && points.get({1, 2}) == "a" && points.get({2, 1}) == "b",
+          "struct keys use the given hash and operator==");
+
+    BasicHashTable<Point, string, PointHash> copy = points;
+    points.insert_or_assign({1, 2}, "changed");
+    size_t visited = 0;
+    for (const auto& [key, value] : copy) {
+        visited += (key == Point{1, 2} && value == "a") || (key == Point{2, 1} && value == "b");
+    }
+    check(visited == 2 && points.get({1, 2}) == "changed", "copies of struct keyed tables are independent");
+    cout << endl;
+}
+
+/**
+* testFlatIntegerKeys: FlatIntegerHashTable keeps uint32_t keys in flat key and value arrays, including the
+*   two key values the layout reserves for empty and removed slots
+*/
+static void testFlatIntegerKeys() {
+    cout << "Testing flat integer keys" << endl;
+    cout << "-------------------------" << endl;
+
+    const uint32_t emptyKey = numeric_limits<uint32_t>::max();
+    const uint32_t removedKey = emptyKey - 1;
+    FlatIntegerHashTable<uint32_t, uint32_t> table;
+    check(table.insert(emptyKey, 1) && table.insert(removedKey, 2) && !table.insert(emptyKey, 3),
+          "reserved key values can be inserted once");
+    check(table.get(emptyKey) == 1u && table.get(removedKey) == 2u && table.size() == 2,
+          "reserved key values are found");
+
+    for (uint32_t i = 0; i < 5000; i++) {
+        table.insert(i, i * 3);
+    }
+    bool correct = table.size() == 5002 && (table.capacity() & (table.capacity() - 1)) == 0;
+    for (uint32_t i = 0; i < 5000; i++) {
+        correct &= table.get(i) == i * 3;
+    }
+    check(correct, "grows through power of two capacities keeping every key");
+
+    //Churn so removed slots pile up and have to be cleared by rehashing at the same size
+    for (uint32_t round = 0; round < 20; round++) {
+        for (uint32_t i = 0; i < 5000; i += 2) {
+            table.remove(i);
+        }
+        for (uint32_t i = 0; i < 5000; i += 2) {
+            table.insert(i, i * 3 + round);
+        }
+    }
+    correct = table.size() == 5002 && table.remove(removedKey) && !table.contains(removedKey);
+    for (uint32_t i = 0; i < 5000; i++) {
+        correct &= table.get(i) == i * 3 + (i % 2 == 0 ? 19 : 0);
+    }
+    check(correct, "removes and reinserts keep every key findable");
+
+    size_t visited = 0;
+    uint64_t keySum = 0;
+    for (auto [key, value] : table) {
+        visited++;
+        keySum += key;
+        value += 1;
+    }
+    check(visited == table.size() && keySum == 4999ull * 5000 / 2 + emptyKey && table.get(7) == 22u,
+          "iteration visits every key once and values are writable");
+
+    vector<uint32_t> lookups = {1, 2, emptyKey, removedKey, 6000};
+    vector<optional<uint32_t>> results(lookups.size());
+    check(table.getBatch(lookups, results) == 3 && results[2] == 2u && !results[3] && !results[4],
+          "getBatch handles reserved and missing keys");
+
+    //Without the alias integer keys get the general table and all of its modes
+    BasicHashTable<uint32_t, uint32_t> general;
+    general.setRobinHood(true);
+    general.setBloomFilter(true);
+    general.setCacheCapacity(100);
+    for (uint32_t i = 0; i < 200; i++) {
+        general.insert(i, i);
+    }
+    correct = general.size() == 100 && general.isRobinHood() && general.getCacheCapacity() == 100;
+    size_t kept = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        optional<uint32_t> value = general.getHashed(i, general.hash(i));
+        correct &= !value || value == i;
+        kept += value.has_value();
+    }
+    correct &= kept == 100;
+    check(correct, "plain integer keyed tables keep every mode");
+    cout << endl;
+}
+
+/**
+* testHashFunctions: WyHash and SipHash match their reference test vectors, and each table gets its
+*   own seed
+*/
+static void testHashFunctions() {
+    cout << "Testing hash functions" << endl;
+    cout << "----------------------" << endl;
+
+    //Test vectors from the wyhash final version 4 and SipHash-2-4 reference code
+    const string digits = "12345678901234567890123456789012345678901234567890123456789012345678901234567890";
+    check(WyHash(0)("") == 0x93228a4de0eec5a2ULL && WyHash(3)("message digest") == 0x786d1f1df3801df4ULL &&
+          WyHash(6)(digits) == 0x6cc5eab49a92d617ULL, "WyHash matches the reference vectors");
+    string bytes;
+    for (char i = 0; i < 15; i++) {
+        bytes += i;
+    }
+    SipHash sipHash(0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL);
+    check(sipHash("") == 0x726fdb47dd0e0e31ULL && sipHash(bytes) == 0xa129ca6149be45e5ULL,
+          "SipHash matches the reference vectors");
+
+    HashTable first;
+    HashTable second;
+    HashTable copy = first;
+    check(first.hash("key") != second.hash("key") && copy.hash("key") == first.hash("key"),
+          "tables are seeded apart and copies keep their seed");
+
+    BasicHashTable<string, size_t, SipHash> hostile;
+    for (size_t i = 0; i < 1000; i++) {
+        hostile.insert("key" + to_string(i), i);
+    }
+    check(hostile.size() == 1000 && hostile.get("key999") == 999u && hostile.contains(string_view("key5")),
+          "a SipHash keyed table works like a HashTable");
+    cout << endl;
+}
+
+/**
+* testRobinHood: Robin Hood tables keep every key findable through inserts, backward shift removes,
+*   incremental resizes and mode switches, without ever leaving removed buckets behind
+*/
+static void testRobinHood() {
+    cout << "Testing Robin Hood mode" << endl;
+    cout << "-----------------------" << endl;
+
+    HashTable ht;
+    ht.insert("before", 1);
+    ht.setRobinHood(true);
+    ht.setMaxLoadFactor(0.9);
+    for (size_t i = 0; i < 20000; i++) {
+        ht.insert(to_string(i), i);
+    }
+    check(ht.isRobinHood() && ht.get("before") == 1u && ht.size() == 20001, "switching modes keeps the keys");
+
+    for (size_t i = 0; i < 20000; i += 3) {
+        ht.remove(to_string(i));
+    }
+    bool correct = ht.removedCount() == 0 && ht.stats().removedBuckets == 0;
+    for (size_t i = 0; i < 20000; i++) {
+        correct &= ht.contains(to_string(i)) == (i % 3 != 0);
+    }
+    check(correct, "removes shift keys back instead of leaving removed buckets");
+
+    for (size_t i = 0; i < 20000; i += 3) {
+        ht.insert(to_string(i), i * 2);
+    }
+    correct = ht.size() == 20001;
+    for (size_t i = 0; i < 20000; i++) {
+        correct &= ht.get(to_string(i)) == (i % 3 == 0 ? i * 2 : i);
+        correct &= !ht.contains("missing" + to_string(i));
+    }
+    check(correct, "reinserted keys are found and misses stop early without false hits");
+
+    HashTable incremental;
+    incremental.setRobinHood(true);
+    incremental.setIncrementalResize(true);
+    correct = true;
+    for (size_t i = 0; i < 5000; i++) {
+        incremental.insert(to_string(i), i);
+        //Removing while buckets migrate exercises the old table's removed buckets
+        if (i % 4 == 0) {
+            correct &= incremental.remove(to_string(i / 2));
+        }
+    }
+    for (size_t i = 0; i < 5000; i++) {
+        bool removed = i < 2500 && (i * 2) % 4 == 0;
+        correct &= incremental.contains(to_string(i)) != removed;
+    }
+    check(correct && incremental.removedCount() == 0, "incremental resizes work in Robin Hood mode");
+
+    HashTable copy = ht;
+    copy.setRobinHood(false);
+    check(copy.size() == ht.size() && copy.get("3") == 6u && ht.get("3") == 6u, "copies can switch back to the default probing");
+    cout << endl;
+}
+
+/**
+* testCuckoo: cuckoo mode keeps every key reachable at load factors past .9, through kicks, the stash,
+*   resizes, removes and snapshots
+*/
+static void testCuckoo() {
+    cout << "Testing cuckoo mode" << endl;
+    cout << "-------------------" << endl;
+
+    HashTable ht;
+    ht.insert("before", 1);
+    ht.setCuckoo(true);
+    ht.setMaxLoadFactor(0.93);
+    const size_t count = 50000;
+    ht.reserve(count + 1);
+    size_t capacity = ht.capacity();
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+    }
+    bool correct = ht.isCuckoo() && !ht.isRobinHood() && ht.get("before") == 1u && ht.size() == count + 1;
+    for (size_t i = 0; i < count; i++) {
+        correct &= ht.get(to_string(i)) == i && !ht.contains("missing" + to_string(i));
+    }
+    check(correct && ht.capacity() == capacity && ht.alpha() > 0.9, "tables fill past .9 without growing");
+
+    for (size_t i = 0; i < count; i += 3) {
+        ht.remove(to_string(i));
+    }
+    for (size_t i = 0; i < count; i += 6) {
+        ht.insert(to_string(i), i * 2);
+    }
+    correct = ht.removedCount() == 0;
+    for (size_t i = 0; i < count; i++) {
+        correct &= ht.get(to_string(i)) == (i % 6 == 0 ? optional<size_t>(i * 2) : i % 3 == 0 ? nullopt : optional<size_t>(i));
+    }
+    check(correct, "removes free buckets and reinserted keys are found");
+
+    //One set of four buckets and the stash, so most keys end up in the stash
+    HashTable tiny;
+    tiny.setCuckoo(true);
+    tiny.setMaxLoadFactor(0.9);
+    for (size_t i = 0; i < 10; i++) {
+        tiny.insert(to_string(i), i);
+    }
+    correct = tiny.capacity() == 12;
+    for (size_t i = 0; i < 10; i += 2) {
+        correct &= tiny.remove(to_string(i));
+    }
+    for (size_t i = 0; i < 10; i++) {
+        correct &= tiny.contains(to_string(i)) == (i % 2 == 1);
+    }
+    check(correct, "keys in the stash are found and removed");
+
+    //Close to full, some inserts run out of kicks and stash and grow the table instead
+    HashTable full;
+    full.setCuckoo(true);
+    full.setMaxLoadFactor(0.99);
+    full.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        full.insert("key" + to_string(i), i);
+    }
+    correct = full.size() == count;
+    for (size_t i = 0; i < count; i++) {
+        correct &= full.get("key" + to_string(i)) == i;
+    }
+    check(correct, "inserts that find no bucket grow the table and keep every key");
+
+    const string path = (filesystem::temp_directory_path() / "hashtable_cuckoo_snapshot.bin").string();
+    HashTable loaded;
+    correct = ht.save(path) && loaded.load(path) && loaded.isCuckoo() && loaded.size() == ht.size();
+    for (size_t i = 0; i < count; i++) {
+        correct &= loaded.get(to_string(i)) == ht.get(to_string(i));
+    }
+    filesystem::remove(path);
+    check(correct, "snapshots keep cuckoo mode");
+
+    ht.setRobinHood(true);
+    correct = ht.isRobinHood() && !ht.isCuckoo() && ht.get("before") == 1u && ht.get("6") == 12u;
+    check(correct, "switching to Robin Hood turns cuckoo mode off and keeps the keys");
+    cout << endl;
+}
+
+/**
+* testBloomFilter: with the Bloom filter on every key is still found through inserts, removes, resizes
+*   of every kind, batches and snapshots, while nearly all misses stop at the filter
+*/
+static void testBloomFilter() {
+    cout << "Testing Bloom filter" << endl;
+    cout << "--------------------" << endl;
+
+    BloomFilter filter;
+    filter.reset(10000);
+    for (uint64_t i = 0; i < 10000; i++) {
+        filter.add(i * 0x9E3779B97F4A7C15ULL);
+    }
+    bool correct = filter.capacity() == 10000 && filter.bytesUsed() >= 10000 * BloomFilter::BITS_PER_KEY / 8 && filter.bytesUsed() % 64 == 0;
+    size_t falsePositives = 0;
+    for (uint64_t i = 0; i < 10000; i++) {
+        correct &= filter.mayContain(i * 0x9E3779B97F4A7C15ULL);
+        falsePositives += filter.mayContain((i + 10000) * 0x9E3779B97F4A7C15ULL);
+    }
+    check(correct && falsePositives < 200, "filters never miss an added key and let few others through");
+
+    const size_t count = 50000;
+    HashTable ht;
+    ht.insert("before", 0);
+    ht.setBloomFilter(true);
+    ht.setIncrementalResize(true);
+    correct = ht.hasBloomFilter() && ht.bloomFilterBytes() > 0;
+    for (size_t i = 0; i < count; i++) {
+        ht.insert(to_string(i), i);
+        //Keys added mid migration have to be found before and after it finishes
+        correct &= ht.contains(to_string(i / 2)) && ht.contains("before");
+    }
+    ht.resetStats();
+    for (size_t i = 0; i < count; i++) {
+        correct &= ht.get(to_string(i)) == i && !ht.contains("missing" + to_string(i));
+    }
+    HashTableStats stats = ht.stats();
+    check(correct, "keys are found through incremental resizes");
+    check(!HASHTABLE_STATS_ENABLED || (stats.bloomRejects + stats.bloomFalsePositives == count && stats.bloomFalsePositiveRate() < 0.03),
+          "misses stop at the filter and the false positive rate is reported");
+
+    for (size_t i = 0; i < count; i += 2) {
+        ht.remove(to_string(i));
+    }
+    for (size_t i = 0; i < count; i += 4) {
+        ht.insert(to_string(i), i * 2);
+    }
+    correct = true;
+    for (size_t i = 0; i < count; i++) {
+        correct &= ht.get(to_string(i)) == (i % 4 == 0 ? optional<size_t>(i * 2) : i % 2 == 0 ? nullopt : optional<size_t>(i));
+    }
+    check(correct, "removed keys are gone and reinserted keys are found after the filter is rebuilt");
+
+    //Churn at a steady size so the filter goes stale, incremental tables rebuild it by migrating
+    HashTable churn;
+    churn.setIncrementalResize(true);
+    churn.setRobinHood(true);
+    churn.setBloomFilter(true);
+    for (size_t i = 0; i < count / 10; i++) {
+        churn.insert(to_string(i), i);
+    }
+    size_t churnCapacity = churn.capacity();
+    churn.resetStats();
+    correct = true;
+    for (size_t i = 0; i < count; i++) {
+        churn.remove(to_string(i));
+        churn.insert(to_string(i + count / 10), i);
+        correct &= churn.contains(to_string(i + 1)) && !churn.contains(to_string(i));
+    }
+    HashTableStats churnStats = churn.stats();
+    correct &= churn.capacity() == churnCapacity && churn.size() == count / 10;
+    check(correct && (!HASHTABLE_STATS_ENABLED || (churnStats.inPlaceRehashCount > 0 && churnStats.resizeCount == 0 &&
+                                                   churnStats.bloomRejects > count / 2)),
+          "churned incremental tables rebuild the filter by migrating");
+
+    for (int mode = 0; mode < 3; mode++) {
+        HashTable other;
+        other.setBloomFilter(true);
+        other.setRehashThreads(4);
+        other.setRobinHood(mode == 1);
+        other.setCuckoo(mode == 2);
+        other.setMaxLoadFactor(mode == 2 ? 0.95 : 0.5);
+        vector<pair<string, size_t>> pairs;
+        for (size_t i = 0; i < 4 * count; i++) {
+            pairs.emplace_back("key" + to_string(i), i);
+        }
+        //The first half goes through single inserts and rehashes, the second through a bulk load
+        for (size_t i = 0; i < 2 * count; i++) {
+            other.insert(pairs[i].first, pairs[i].second);
+        }
+        other.bulkLoad(span(pairs).subspan(2 * count));
+        correct = other.size() == 4 * count;
+        for (size_t i = 0; i < 4 * count; i++) {
+            correct &= other.get(pairs[i].first) == i;
+        }
+        check(correct, mode == 0 ? "parallel rehashes and bulk loads fill the filter"
+                       : mode == 1 ? "Robin Hood tables keep the filter up to date"
+                                   : "cuckoo tables keep the filter up to date through kicks and growth");
+    }
+
+    vector<string> batchKeys;
+    for (size_t i = 0; i < 100; i++) {
+        batchKeys.push_back(to_string(i * 7));
+        batchKeys.push_back("missing" + to_string(i));
+    }
+    vector<string_view> views(batchKeys.begin(), batchKeys.end());
+    vector<optional<size_t>> results(views.size());
+    correct = true;
+    size_t found = ht.getBatch(views, results);
+    size_t expected = 0;
+    for (size_t i = 0; i < 100; i++) {
+        correct &= results[2 * i] == ht.get(batchKeys[2 * i]) && results[2 * i + 1] == nullopt;
+        expected += ht.contains(batchKeys[2 * i]);
+    }
+    correct &= found == expected;
+    check(correct, "batch lookups go through the filter");
+
+    const string path = (filesystem::temp_directory_path() / "hashtable_bloom_snapshot.bin").string();
+    HashTable loaded;
+    loaded.setBloomFilter(true);
+    HashTable copy = ht;
+    correct = ht.save(path) && loaded.load(path) && loaded.hasBloomFilter() && copy.hasBloomFilter();
+    for (size_t i = 0; i < count; i++) {
+        correct &= loaded.get(to_string(i)) == ht.get(to_string(i)) && copy.get(to_string(i)) == ht.get(to_string(i));
+    }
+    filesystem::remove(path);
+    check(correct, "loaded and copied tables build the filter for their keys");
+
+    ht.setBloomFilter(false);
+    correct = !ht.hasBloomFilter() && ht.bloomFilterBytes() == 0 && ht.get("1") == 1u && !ht.contains("missing1");
+    check(correct, "turning the filter off frees it and keeps the keys");
+    cout << endl;
+}
+
+/**
+* testCacheMode: a cache never grows past its entries, evicts keys nobody used before ones that were,
+*   and counts hits, misses and evictions
+*/
+static void testCacheMode() {
+    cout << "Testing cache mode" << endl;
+    cout << "------------------" << endl;
+
+    const size_t entries = 1000;
+    HashTable cache;
+    cache.setCacheCapacity(entries);
+    size_t capacity = cache.capacity();
+    for (size_t i = 0; i < entries; i++) {
+        cache.insert("hot" + to_string(i), i);
+    }
+    //Half the keys are read between batches of a quarter as many cold inserts, too few for the hand to come round twice
+    bool correct = cache.getCacheCapacity() == entries;
+    for (size_t round = 0; round < 20; round++) {
+        for (size_t i = 0; i < entries / 2; i++) {
+            correct &= cache.get("hot" + to_string(i)) == i;
+        }
+        for (size_t i = 0; i < entries / 4; i++) {
+            cache.insert("cold" + to_string(round) + ":" + to_string(i), i);
+            correct &= cache.size() <= entries;
+        }
+    }
+    correct &= cache.capacity() == capacity && cache.size() == entries && cache.isRobinHood();
+    for (size_t i = 0; i < entries / 2; i++) {
+        correct &= cache.get("hot" + to_string(i)) == i;
+    }
+    check(correct, "caches keep their size and their used keys");
+
+    //Only the gets above were lookups, the 5000 cold inserts count as evictions but neither hits nor misses
+    HashTableStats stats = cache.stats();
+    cache.contains("never inserted");
+    cache.insert("hot0", 0);
+    cache.get("never inserted either");
+    HashTableStats afterMisses = cache.stats();
+    correct = afterMisses.cacheMisses == stats.cacheMisses + 2 && afterMisses.cacheHits == stats.cacheHits &&
+              afterMisses.cacheHitRate() < 1.0;
+    check(!HASHTABLE_STATS_ENABLED || (correct && stats.cacheHits == 21 * entries / 2 && stats.cacheMisses == 0 &&
+                                       stats.cacheEvictions == 20 * entries / 4),
+          "lookup hits and misses and evictions are counted, inserts are not");
+
+    //Const readers on several threads mark the same hot buckets after the hand cleared their bits, the
+    //keys they used must outlive the cold ones
+    for (size_t i = 0; i < entries / 4; i++) {
+        cache.insert("sweep" + to_string(i), i);
+    }
+    const HashTable& shared = cache;
+    vector<thread> readers;
+    for (size_t t = 0; t < 4; t++) {
+        readers.emplace_back([&shared]() {
+            for (size_t i = 0; i < entries / 2; i++) {
+                shared.get("hot" + to_string(i));
+            }
+        });
+    }
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    for (size_t i = 0; i < entries / 4; i++) {
+        cache.insert("shared" + to_string(i), i);
+    }
+    correct = cache.size() == entries;
+    for (size_t i = 0; i < entries / 2; i++) {
+        correct &= cache.contains("hot" + to_string(i));
+    }
+    check(correct, "reference bits set by concurrent readers keep their keys");
+
+    HashTable ht;
+    ht.setCuckoo(true);
+    for (size_t i = 0; i < 3 * entries; i++) {
+        ht.insert(to_string(i), i);
+    }
+    ht.setCacheCapacity(entries);
+    correct = ht.size() == entries && !ht.isCuckoo() && ht.isRobinHood() && ht.capacity() == 2 * entries;
+    size_t kept = 0;
+    for (size_t i = 0; i < 3 * entries; i++) {
+        optional<size_t> value = ht.get(to_string(i));
+        correct &= !value || value == i;
+        kept += value.has_value();
+    }
+    ht.reserve(10 * entries);
+    ht.insertBatch(vector<pair<string_view, size_t>>{{"a", 1}, {"b", 2}});
+    ht.setMaxLoadFactor(0.8);
+    correct &= kept == entries && ht.size() == entries && ht.capacity() == 1250 && ht.get("b") == 2u;
+    check(correct, "turning a table into a cache evicts what does not fit and reserve leaves it alone");
+
+    const string path = (filesystem::temp_directory_path() / "hashtable_cache_snapshot.bin").string();
+    HashTable big;
+    for (size_t i = 0; i < 2 * entries; i++) {
+        big.insert(to_string(i), i);
+    }
+    correct = big.save(path) && ht.load(path) && ht.size() == entries && ht.getCacheCapacity() == entries;
+    filesystem::remove(path);
+    ht.setRobinHood(false);
+    for (size_t i = 0; i < 2 * entries; i++) {
+        ht.insert("more" + to_string(i), i);
+    }
+    correct &= ht.size() == 3 * entries && ht.getCacheCapacity() == 0;
+    check(correct, "loaded snapshots are cut down to the cache size and leaving Robin Hood mode ends the cache");
+    cout << endl;
+}
+
+/**
+* testSnapshots: tables saved and loaded back hold the same keys in the same buckets, including mid
+*   resize and in Robin Hood mode, and bad files are refused without touching the table
+*/
+static void testSnapshots() {
+    cout << "Testing snapshots" << endl;
+    cout << "-----------------" << endl;
+
+    const string path = (filesystem::temp_directory_path() / "hashtable_snapshot_test.bin").string();
+    HashTable ht;
+    for (size_t i = 0; i < 10000; i++) {
+        ht.insert("key" + to_string(i), i);
+    }
+    for (size_t i = 0; i < 10000; i += 7) {
+        ht.remove("key" + to_string(i));
+    }
+    HashTable loaded;
+    bool correct = ht.save(path) && loaded.load(path);
+    correct &= loaded.size() == ht.size() && loaded.capacity() == ht.capacity() && loaded.removedCount() == ht.removedCount();
+    for (size_t i = 0; i < 10000; i++) {
+        string key = "key" + to_string(i);
+        correct &= loaded.get(key) == ht.get(key) && loaded.getIndex(key) == ht.getIndex(key);
+    }
+    check(correct, "a loaded table has every key in the bucket it was saved in");
+#ifndef _WIN32
+    //The file holds the hash state, which for keyed hashes is a secret
+    check(filesystem::status(path).permissions() == (filesystem::perms::owner_read | filesystem::perms::owner_write),
+          "snapshots are readable by their owner only");
+#endif
+    check(loaded.insert("new", 1) && loaded.remove("key1") && loaded.size() == ht.size(), "a loaded table can be changed");
+
+    HashTable resizing;
+    resizing.setIncrementalResize(true);
+    resizing.setRobinHood(true);
+    for (size_t i = 0; resizing.size() < 1000 || !resizing.isResizing(); i++) {
+        resizing.insert(to_string(i), i);
+    }
+    correct = resizing.save(path) && loaded.load(path) && loaded.isResizing() && loaded.isRobinHood();
+    for (size_t i = 0; i < resizing.size(); i++) {
+        correct &= loaded.get(to_string(i)) == i;
+    }
+    for (size_t i = 0; i < 5000; i++) {
+        loaded.insert("more" + to_string(i), i);
+    }
+    check(correct && !loaded.isResizing() && loaded.get("more4999") == 4999u, "snapshots taken mid resize finish the resize after loading");
+
+    BasicHashTable<int64_t, double> numbers;
+    for (int64_t i = -500; i < 500; i++) {
+        numbers.insert(i, static_cast<double>(i) / 2);
+    }
+    BasicHashTable<int64_t, double> numbersLoaded;
+    check(numbers.save(path) && numbersLoaded.load(path) && numbersLoaded.get(-301) == -150.5 && numbersLoaded.size() == 1000,
+          "tables with keys stored in the buckets are saved too");
+
+    //Cut the file short and flip its magic, both have to be refused without changing the table
+    filesystem::resize_file(path, filesystem::file_size(path) / 2);
+    bool truncatedRefused = !numbersLoaded.load(path);
+    {
+        ofstream out(path, ios::binary | ios::in | ios::out);
+        out.write("X", 1);
+    }
+    check(truncatedRefused && !numbersLoaded.load(path) && !numbersLoaded.load(path + ".missing") && numbersLoaded.size() == 1000,
+          "truncated, corrupt and missing files are refused");
+    filesystem::remove(path);
+    cout << endl;
+}
+
+/**
+* testFrozenHashTable: a frozen file answers every key of the table it was built from, refuses keys it
+*   was not built from, and a bad file leaves the open one in place
+*/
+static void testFrozenHashTable() {
+    cout << "Testing FrozenHashTable" << endl;
+    cout << "-----------------------" << endl;
+
+    const string path = (filesystem::temp_directory_path() / "hashtable_frozen_test.bin").string();
+    HashTable ht;
+    for (size_t i = 0; i < 20000; i++) {
+        ht.insert("key" + to_string(i), i * 3);
+    }
+    ht.insert("", 7);
+    ht.insert(string(1000, 'x'), 8);
+
+    FrozenHashTable frozen;
+    bool correct = FrozenHashTable::write(ht, path) && frozen.open(path) && frozen.size() == ht.size();
+    for (size_t i = 0; i < 20000; i++) {
+        correct &= frozen.get("key" + to_string(i)) == i * 3;
+        correct &= !frozen.contains("miss" + to_string(i));
+    }
+    check(correct && frozen.get("") == 7u && frozen.get(string(1000, 'x')) == 8u, "every key is found in one probe and misses are refused");
+
+    FrozenHashTable second;
+    check(second.open(path) && second.get("key42") == 126u, "several tables can map the same file");
+    FrozenHashTable moved = std::move(second);
+    check(moved.get("key42") == 126u && !second.isOpen() && !second.contains("key42"), "moving a table moves its mapping");
+
+    HashTable empty;
+    FrozenHashTable frozenEmpty;
+    check(FrozenHashTable::write(empty, path + ".empty") && frozenEmpty.open(path + ".empty") && frozenEmpty.size() == 0 &&
+          !frozenEmpty.contains("key1"), "empty tables freeze too");
+    filesystem::remove(path + ".empty");
+
+    {
+        ofstream out(path, ios::binary | ios::in | ios::out);
+        out.write("X", 1);
+    }
+    check(!frozen.open(path) && !frozen.open(path + ".missing") && frozen.get("key7") == 21u,
+          "bad files are refused and the open file stays in use");
+    filesystem::remove(path);
+    cout << endl;
+}
+
+/**
+* testParallelRehash: resizes of big tables split between threads keep every key, in both probing modes
+*/
+static void testParallelRehash() {
+    cout << "Testing parallel rehash" << endl;
+    cout << "-----------------------" << endl;
+
+    for (bool robinHood : {false, true}) {
+        HashTable ht;
+        ht.setRehashThreads(4);
+        ht.setRobinHood(robinHood);
+        const size_t count = 200000;
+        for (size_t i = 0; i < count; i++) {
+            ht.insert("key" + to_string(i), i);
+        }
+        bool correct = ht.size() == count && ht.getRehashThreads() == 4;
+        for (size_t i = 0; i < count; i++) {
+            correct &= ht.get("key" + to_string(i)) == i;
+        }
+        //Removes shift Robin Hood keys back using the distances the parallel rehash worked out
+        for (size_t i = 0; i < count; i += 2) {
+            correct &= ht.remove("key" + to_string(i));
+        }
+        ht.reserve(count * 2);
+        for (size_t i = 0; i < count; i++) {
+            correct &= ht.contains("key" + to_string(i)) == (i % 2 == 1);
+            correct &= !ht.contains("miss" + to_string(i));
+        }
+        check(correct, robinHood ? "Robin Hood tables rehashed by several threads keep every key"
+                                 : "tables rehashed by several threads keep every key");
+    }
+
+    BasicHashTable<int64_t, int64_t> numbers;
+    numbers.setRehashThreads(3);
+    for (int64_t i = 0; i < 100000; i++) {
+        numbers.insert(-i, i);
+    }
+    bool correct = numbers.size() == 100000;
+    for (int64_t i = 0; i < 100000; i++) {
+        correct &= numbers.get(-i) == i;
+    }
+    check(correct, "keys stored in the buckets are rehashed by several threads too");
+    cout << endl;
+}
+
+/**
+* testBulkLoad: bulk loads from several threads insert each new key once, first value winning, and
+*   leave keys already in the table alone
+*/
+static void testBulkLoad() {
+    cout << "Testing bulk load" << endl;
+    cout << "-----------------" << endl;
+
+    const size_t count = 200000;
+    vector<pair<string, size_t>> pairs;
+    for (size_t i = 0; i < count; i++) {
+        pairs.emplace_back("key" + to_string(i), i);
+    }
+    //Repeats of earlier keys with other values, spread through the batch
+    for (size_t i = 0; i < count; i += 7) {
+        pairs.emplace_back("key" + to_string(i), i + 1);
+    }
+
+    HashTable built(pairs);
+    bool correct = built.size() == count && built.alpha() <= built.getMaxLoadFactor();
+    for (size_t i = 0; i < count; i++) {
+        correct &= built.get("key" + to_string(i)) == i;
+    }
+    check(correct, "the range constructor holds every key with its first value");
+
+    for (bool robinHood : {false, true}) {
+        HashTable ht;
+        ht.setRehashThreads(4);
+        ht.setRobinHood(robinHood);
+        for (size_t i = 0; i < 1000; i++) {
+            ht.insert("old" + to_string(i), i);
+            ht.insert("key" + to_string(i), 0);
+        }
+        for (size_t i = 0; i < 1000; i += 2) {
+            ht.remove("old" + to_string(i));
+        }
+        ht.reserve(count * 2 + 2000);
+        size_t capacity = ht.capacity();
+        size_t inserted = ht.bulkLoad(pairs);
+        correct = inserted == count - 1000 && ht.size() == count + 500 && ht.capacity() == capacity;
+        for (size_t i = 0; i < count; i++) {
+            correct &= ht.get("key" + to_string(i)) == (i < 1000 ? 0 : i);
+        }
+        //Removes shift Robin Hood keys back using the distances the bulk load worked out
+        for (size_t i = 0; i < 1000; i++) {
+            correct &= ht.remove("old" + to_string(i)) == (i % 2 == 1);
+        }
+        for (size_t i = 0; i < count; i++) {
+            correct &= ht.contains("key" + to_string(i)) && !ht.contains("miss" + to_string(i));
+        }
+        check(correct, robinHood ? "Robin Hood bulk loads from several threads skip keys already there"
+                                 : "bulk loads from several threads skip keys already there and reuse removed buckets");
+    }
+
+    HashTable small;
+    small.insert("key1", 5);
+    vector<pair<string_view, size_t>> few = {{"key1", 1}, {"key2", 2}, {"key2", 3}};
+    correct = small.bulkLoad(few) == 1 && small.get("key1") == 5u && small.get("key2") == 2u;
+    check(correct, "small bulk loads insert in order on the calling thread");
+
+    vector<pair<uint64_t, uint64_t>> numbers;
+    for (uint64_t i = 0; i < 50000; i++) {
+        numbers.emplace_back(i * 3, i);
+    }
+    numbers.emplace_back(numeric_limits<uint64_t>::max(), 9);
+    FlatIntegerHashTable<uint64_t, uint64_t> flat(numbers);
+    correct = flat.size() == 50001 && flat.get(numeric_limits<uint64_t>::max()) == 9u;
+    for (uint64_t i = 0; i < 50000; i++) {
+        correct &= flat.get(i * 3) == i;
+    }
+    check(correct, "flat integer tables build from a range too");
+    cout << endl;
+}
+
+/**
+* CountingResource: memory resource that counts the bytes it has handed out and not had back, so a
+*   test can tell where a table's memory came from and that all of it was returned
+*/
+class CountingResource : public pmr::memory_resource {
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            outstanding.fetch_add(bytes);
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+            outstanding.fetch_sub(bytes);
+            pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    public:
+        atomic<size_t> outstanding{0};
+};
+
+/**
+* testMemoryResources: pmr tables take buckets and keys from their resource, through rehashes and
+*   assignment, and HugePageResource maps big tables from the OS
+*/
+static void testMemoryResources() {
+    cout << "Testing memory resources" << endl;
+    cout << "------------------------" << endl;
+
+    CountingResource first;
+    CountingResource second;
+    CountingResource fallback;
+    {
+        PmrHashTable ht(HashTable::DEFAULT_INITIAL_CAPACITY, WyHash(), equal_to<>(), &first);
+        ht.setRehashThreads(4);
+        const size_t count = 100000;
+        for (size_t i = 0; i < count; i++) {
+            ht.insert("a longer key so the arena fills several slabs " + to_string(i), i);
+        }
+        size_t bucketBytes = ht.capacity() * 24;
+        check(ht.get_allocator().resource() == &first && first.outstanding > bucketBytes + count * 40,
+              "buckets and keys come from the table's resource");
+
+        PmrHashTable copy(8, WyHash(), equal_to<>(), &second);
+        copy.insert("other", 1);
+        //Anything a copy took from the default resource instead of the table's own would show up here
+        pmr::memory_resource* defaultResource = pmr::set_default_resource(&fallback);
+        copy = ht;
+        pmr::set_default_resource(defaultResource);
+        bool correct = copy.get_allocator().resource() == &second && copy.size() == count && fallback.outstanding == 0 &&
+                       second.outstanding > count * 40;
+        for (size_t i = 0; i < count; i += 7) {
+            correct &= copy.get("a longer key so the arena fills several slabs " + to_string(i)) == i;
+        }
+        ht = PmrHashTable(8, WyHash(), equal_to<>(), &second);
+        correct &= ht.get_allocator().resource() == &first && ht.size() == 0 && copy.get("other") == nullopt;
+        check(correct, "assigning tables keeps each table's own resource");
+    }
+    check(first.outstanding == 0 && second.outstanding == 0, "everything taken from a resource is given back");
+
+    HugePageResource hugePages;
+    {
+        PmrHashTable ht(HashTable::DEFAULT_INITIAL_CAPACITY, WyHash(), equal_to<>(), &hugePages);
+        ht.reserve(200000);
+        bool correct = hugePages.mappedBytes() >= ht.capacity() * 24 && hugePages.mappedBytes() % HugePageResource::HUGE_PAGE_SIZE == 0;
+        for (size_t i = 0; i < 200000; i++) {
+            ht.insert("key" + to_string(i), i);
+        }
+        for (size_t i = 0; i < 200000; i++) {
+            correct &= ht.get("key" + to_string(i)) == i;
+        }
+        check(correct, "big tables are mapped in whole huge pages");
+
+        size_t mapped = hugePages.mappedBytes();
+        BasicPmrHashTable<uint64_t, uint64_t> flat(1 << 18, WyHash(), equal_to<>(), &hugePages);
+        flat.insert(7, 49);
+        check(flat.get(7) == 49u && hugePages.mappedBytes() - mapped >= (size_t(1) << 18) * 16,
+              "flat integer tables allocate from the resource too");
+    }
+    check(hugePages.mappedBytes() == 0, "huge pages are unmapped when the tables go");
+    cout << endl;
+}
 
 int main() {
-    std::cout << "Hello, World!" << std::endl;
-    return 0;
-}
\ No newline at end of file
+    testHashFunctions();
+    testIncrementalResize();
+    testKeyArena();
+    testHeterogeneousLookup();
+    testIterators();
+    testRemovedCompaction();
+    testSizingControls();
+    testStats();
+    testRobinHood();
+    testCuckoo();
+    testBloomFilter();
+    testCacheMode();
+    testSnapshots();
+    testParallelRehash();
+    testBulkLoad();
+    testMemoryResources();
+    testBatchOperations();
+    testGenericKeys();
+    testFlatIntegerKeys();
+    testConcurrentHashTable();
+    testOptimisticHashTable();
+    testFrozenHashTable();
+    testSwissHashTable();
+    return anyErrors ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * HugePageResource.cpp
+ */
+
+#include "HugePageResource.h"
+
+#include <cstdint>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+/**
+* roundUp: round a byte count up to a whole number of huge pages
+*/
+size_t roundUp(size_t bytes) {
+    return (bytes + HugePageResource::HUGE_PAGE_SIZE - 1) / HugePageResource::HUGE_PAGE_SIZE * HugePageResource::HUGE_PAGE_SIZE;
+}
+
+}
+
+/**
+* HugePageResource constructor: Makes a resource with nothing mapped yet
+*
+* param :
+*   upstream: where allocations smaller than a huge page go
+*/
+HugePageResource::HugePageResource(std::pmr::memory_resource* upstream)
+    : upstream(upstream), mapped(0), explicitFailed(false) {}
+
+/**
+* do_allocate: map whole huge pages for a big allocation, or pass a small one upstream
+*
+* param :
+*   bytes: size of the allocation
+*   alignment: alignment it needs, mappings are page aligned so anything up to a huge page is met
+*
+* returns:
+*   void*: start of the allocation, std::bad_alloc is thrown if the OS is out of memory
+*/
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes < HUGE_PAGE_SIZE or alignment > HUGE_PAGE_SIZE) {
+        return this->upstream->allocate(bytes, alignment);
+    }
+    size_t length = roundUp(bytes);
+
+#ifdef _WIN32
+    if (!this->explicitFailed.load(std::memory_order_relaxed)) {
+        size_t largePage = GetLargePageMinimum();
+        if (largePage != 0 and length % largePage == 0) {
+            void* pointer = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (pointer != nullptr) {
+                this->mapped.fetch_add(length, std::memory_order_relaxed);
+                return pointer;
+            }
+        }
+        this->explicitFailed.store(true, std::memory_order_relaxed);
+    }
+    void* pointer = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    this->mapped.fetch_add(length, std::memory_order_relaxed);
+    return pointer;
+#else
+#ifdef MAP_HUGETLB
+    if (!this->explicitFailed.load(std::memory_order_relaxed)) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        //Ask for 2MB pages by name in case the system default huge page is 1GB
+        flags |= 21 << MAP_HUGE_SHIFT;
+#endif
+        void* pointer = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (pointer != MAP_FAILED) {
+            this->mapped.fetch_add(length, std::memory_order_relaxed);
+            return pointer;
+        }
+        this->explicitFailed.store(true, std::memory_order_relaxed);
+    }
+#endif
+
+    //Map one huge page extra so a 2MB aligned range fits, then unmap the ends around it. The kernel
+    //can only back aligned 2MB ranges with transparent huge pages
+    size_t spare = length + HUGE_PAGE_SIZE;
+    void* raw = mmap(nullptr, spare, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    uintptr_t rawStart = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t start = roundUp(rawStart);
+    if (start > rawStart) {
+        munmap(raw, start - rawStart);
+    }
+    if (rawStart + spare > start + length) {
+        munmap(reinterpret_cast<void*>(start + length), rawStart + spare - (start + length));
+    }
+    void* pointer = reinterpret_cast<void*>(start);
+#ifdef MADV_HUGEPAGE
+    madvise(pointer, length, MADV_HUGEPAGE);
+#endif
+    this->mapped.fetch_add(length, std::memory_order_relaxed);
+    return pointer;
+#endif
+}
+
+/**
+* do_deallocate: unmap a big allocation, or pass a small one back upstream
+*
+* param :
+*   pointer: start of the allocation
+*   bytes: size it was allocated with
+*   alignment: alignment it was allocated with
+*/
+void HugePageResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    if (bytes < HUGE_PAGE_SIZE or alignment > HUGE_PAGE_SIZE) {
+        this->upstream->deallocate(pointer, bytes, alignment);
+        return;
+    }
+    size_t length = roundUp(bytes);
+#ifdef _WIN32
+    VirtualFree(pointer, 0, MEM_RELEASE);
+#else
+    munmap(pointer, length);
+#endif
+    this->mapped.fetch_sub(length, std::memory_order_relaxed);
+}
+
+/**
+* do_is_equal: resources can only free each other's memory if they are the same object
+*/
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+/**
+* mappedBytes: get the bytes currently mapped from the OS for big allocations. HugePages_Total and
+*   AnonHugePages in /proc/meminfo show how much of that the kernel backed with huge pages.
+*
+* returns:
+*   size_t: bytes mapped, in whole huge pages
+*/
+size_t HugePageResource::mappedBytes() const {
+    return this->mapped.load(std::memory_order_relaxed);
+}
+
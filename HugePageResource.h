@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+/**
+ * HugePageResource.h
+ *
+ * std::pmr::memory_resource that backs big allocations with 2MB pages. A lookup in a big table lands
+ * on a random bucket, and with 4KB pages nearly every one of them is also a TLB miss. 2MB pages let
+ * the same TLB cover 512 times as much of the table. Use it as the allocator of a PmrHashTable:
+ *
+ *     HugePageResource hugePages;
+ *     PmrHashTable table(HashTable::DEFAULT_INITIAL_CAPACITY, WyHash(), std::equal_to<>(), &hugePages);
+ *
+ * Allocations of at least HUGE_PAGE_SIZE are mapped straight from the OS. On Linux explicit huge pages
+ * (MAP_HUGETLB) are tried first, and if none are reserved the mapping is 2MB aligned and madvise'd for
+ * transparent huge pages. On Windows large pages are tried, which needs the lock pages in memory
+ * privilege. Everything smaller, such as key arena slabs, goes to the upstream resource. The resource
+ * is thread safe as long as the upstream one is, so parallel rehashes can allocate from it.
+ */
+class HugePageResource : public std::pmr::memory_resource {
+    private:
+        std::pmr::memory_resource* upstream;
+        std::atomic<size_t> mapped;
+        //Set once explicit huge pages fail so later allocations skip straight to the fallback
+        std::atomic<bool> explicitFailed;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    public:
+        static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        explicit HugePageResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        HugePageResource(const HugePageResource&) = delete;
+        HugePageResource& operator=(const HugePageResource&) = delete;
+
+        size_t mappedBytes() const;
+};
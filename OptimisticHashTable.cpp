@@ -0,0 +1,539 @@
+/**
+ * OptimisticHashTable.cpp
+ */
+
+#include "OptimisticHashTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr uint64_t INACTIVE_EPOCH = UINT64_MAX;
+
+//Each reader thread owns one slot on its own cache line, the only memory a reader ever writes
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{INACTIVE_EPOCH};
+    std::atomic<bool> owned{false};
+};
+
+//Shared by every OptimisticHashTable so a thread claims one slot no matter how many tables it reads
+std::atomic<uint64_t> globalEpoch{0};
+ReaderSlot readerSlots[OptimisticHashTable::MAX_READER_THREADS];
+std::atomic<size_t> slotsInUse{0};
+
+/**
+* ThreadSlot: claims a reader slot the first time a thread reads and gives it back when the thread exits.
+*   slot stays nullptr if every slot is taken, and that thread's reads fall back to the writer lock.
+*/
+struct ThreadSlot {
+    ReaderSlot* slot = nullptr;
+
+    ThreadSlot() {
+        for (size_t i = 0; i < OptimisticHashTable::MAX_READER_THREADS; i++) {
+            bool expected = false;
+            if (readerSlots[i].owned.compare_exchange_strong(expected, true)) {
+                this->slot = &readerSlots[i];
+                size_t inUse = slotsInUse.load();
+                while (inUse < i + 1 && !slotsInUse.compare_exchange_weak(inUse, i + 1)) {
+                }
+                return;
+            }
+        }
+    }
+
+    ~ThreadSlot() {
+        if (this->slot != nullptr) {
+            this->slot->epoch.store(INACTIVE_EPOCH, std::memory_order_release);
+            this->slot->owned.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadSlot threadSlot;
+
+/**
+* ReadGuard: publishes the epoch a read started in for as long as the read runs. The fence makes sure
+*   the writer either sees the published epoch or the reader sees the writer's latest table.
+*/
+class ReadGuard {
+    private:
+        ReaderSlot* slot;
+
+    public:
+        ReadGuard() : slot(threadSlot.slot) {
+            if (this->slot != nullptr) {
+                this->slot->epoch.store(globalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        ~ReadGuard() {
+            if (this->slot != nullptr) {
+                this->slot->epoch.store(INACTIVE_EPOCH, std::memory_order_release);
+            }
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        bool pinned() const {
+            return this->slot != nullptr;
+        }
+};
+
+}
+
+/**
+* Table constructor: Allocates empty buckets and one version counter per group of GROUP_SIZE buckets
+*
+* param :
+*   capacity: number of buckets, a power of two no smaller than GROUP_SIZE
+*/
+OptimisticHashTable::Table::Table(size_t capacity)
+    : capacity(capacity),
+      buckets(std::make_unique<Bucket[]>(capacity)),
+      versions(std::make_unique<GroupVersion[]>(capacity / GROUP_SIZE)) {
+}
+
+/**
+* OptimisticHashTable constructor: Creates the first table
+*
+* param :
+*   initCapacity: the starting number of buckets, rounded up to a power of two
+*/
+OptimisticHashTable::OptimisticHashTable(size_t initCapacity) {
+    initCapacity = std::bit_ceil(std::max(initCapacity, GROUP_SIZE));
+    this->current.store(new Table(initCapacity), std::memory_order_relaxed);
+    this->numSize = 0;
+    this->numRemoved = 0;
+}
+
+/**
+* OptimisticHashTable destructor: Frees every key and table. No reader may still be using the table.
+*/
+OptimisticHashTable::~OptimisticHashTable() {
+    for (const Retired& entry : this->retired) {
+        delete[] entry.key;
+        delete entry.table;
+    }
+
+    Table* table = this->current.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->buckets[i].hash.load(std::memory_order_relaxed) & FULL_BIT) {
+            delete[] table->buckets[i].key.load(std::memory_order_relaxed);
+        }
+    }
+    delete table;
+}
+
+/**
+* hash: Hash a key. The top bit is always set so a full bucket's hash never matches the empty or
+*   removed markers.
+*
+* param :
+*   key: the key to hash
+*
+* returns:
+*   uint64_t: hash of the key with FULL_BIT set
+*/
+uint64_t OptimisticHashTable::hash(std::string_view key) const {
+    return this->hasher(key) | FULL_BIT;
+}
+
+/**
+* makeKey: Copy a key into its own immutable block, its length followed by its characters. Blocks are
+*   never changed after they are published so a reader can compare against one without a lock.
+*
+* param :
+*   key: the key to copy
+*
+* returns:
+*   const char*: the new block, freed by the destructor or through retire()
+*/
+const char* OptimisticHashTable::makeKey(std::string_view key) {
+    size_t length = key.size();
+    char* block = new char[sizeof(length) + length];
+    std::memcpy(block, &length, sizeof(length));
+    std::memcpy(block + sizeof(length), key.data(), length);
+    return block;
+}
+
+/**
+* keyView: View the characters of a key block made by makeKey
+*
+* param :
+*   key: the key block
+*
+* returns:
+*   std::string_view: the key's characters
+*/
+std::string_view OptimisticHashTable::keyView(const char* key) {
+    size_t length;
+    std::memcpy(&length, key, sizeof(length));
+    return std::string_view(key + sizeof(length), length);
+}
+
+/**
+* readBucket: Look a key up without locking. Buckets are read one group at a time, and a group is read
+*   again if its version was odd (a write in progress) or changed before the read finished.
+*
+* param :
+*   table: the table to search
+*   key: the key to look for
+*   hashValue: hash(key)
+*   value: set to the key's value if it is found
+*
+* returns:
+*   bool: true if the key was found
+*/
+bool OptimisticHashTable::readBucket(const Table& table, std::string_view key, uint64_t hashValue, size_t& value) {
+    size_t mask = table.capacity - 1;
+    size_t index = hashValue & mask;
+    size_t probed = 0;
+    while (probed < table.capacity) {
+        const GroupVersion& group = table.versions[index / GROUP_SIZE];
+        size_t groupEnd = (index / GROUP_SIZE + 1) * GROUP_SIZE;
+
+        uint64_t before = group.version.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        //0 keeps probing into the next group, 1 found the key, -1 hit an empty bucket
+        int result = 0;
+        size_t foundValue = 0;
+        for (size_t i = index; i < groupEnd; i++) {
+            const Bucket& bucket = table.buckets[i];
+            uint64_t bucketHash = bucket.hash.load(std::memory_order_relaxed);
+            if (bucketHash == EMPTY_HASH) {
+                result = -1;
+                break;
+            }
+            if (bucketHash == hashValue) {
+                const char* bucketKey = bucket.key.load(std::memory_order_acquire);
+                if (bucketKey != nullptr && keyView(bucketKey) == key) {
+                    foundValue = bucket.value.load(std::memory_order_relaxed);
+                    result = 1;
+                    break;
+                }
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (group.version.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        if (result != 0) {
+            value = foundValue;
+            return result == 1;
+        }
+        probed += groupEnd - index;
+        index = groupEnd & mask;
+    }
+    return false;
+}
+
+/**
+* findForWrite: Find the bucket holding a key. Only called with the writer lock held, so the buckets
+*   cannot change while they are read.
+*
+* param :
+*   table: the table to search
+*   key: the key to look for
+*   hashValue: hash(key)
+*
+* returns:
+*   std::optional<size_t>: Index of the key's bucket, or nullopt if it is not in the table
+*/
+std::optional<size_t> OptimisticHashTable::findForWrite(const Table& table, std::string_view key, uint64_t hashValue) const {
+    size_t mask = table.capacity - 1;
+    size_t index = hashValue & mask;
+    for (size_t probed = 0; probed < table.capacity; probed++) {
+        const Bucket& bucket = table.buckets[index];
+        uint64_t bucketHash = bucket.hash.load(std::memory_order_relaxed);
+        if (bucketHash == EMPTY_HASH) {
+            return std::nullopt;
+        }
+        if (bucketHash == hashValue && keyView(bucket.key.load(std::memory_order_relaxed)) == key) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return std::nullopt;
+}
+
+/**
+* writeBucket: Change one bucket, with its group's version odd for the duration so readers of the group
+*   retry instead of using a half written bucket
+*
+* param :
+*   table: the table holding the bucket
+*   index: the bucket to change
+*   hashValue: the bucket's new hash, or EMPTY_HASH/REMOVED_HASH
+*   key: the bucket's new key block, nullptr for a removed bucket
+*   value: the bucket's new value
+*/
+void OptimisticHashTable::writeBucket(Table& table, size_t index, uint64_t hashValue, const char* key, size_t value) {
+    GroupVersion& group = table.versions[index / GROUP_SIZE];
+    uint64_t version = group.version.load(std::memory_order_relaxed);
+    group.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Bucket& bucket = table.buckets[index];
+    bucket.hash.store(hashValue, std::memory_order_relaxed);
+    //Release so a reader that loads the pointer also sees the characters written by makeKey
+    bucket.key.store(key, std::memory_order_release);
+    bucket.value.store(value, std::memory_order_relaxed);
+
+    group.version.store(version + 2, std::memory_order_release);
+}
+
+/**
+* insertNew: Place a key that is known not to be in the table, growing first if the table would pass
+*   half full counting removed buckets. Writer lock must be held.
+*
+* param :
+*   key: the key to insert
+*   hashValue: hash(key)
+*   value: the value associated with the key
+*/
+void OptimisticHashTable::insertNew(std::string_view key, uint64_t hashValue, size_t value) {
+    Table* table = this->current.load(std::memory_order_relaxed);
+    if ((this->numSize + this->numRemoved + 1) * 2 > table->capacity) {
+        this->grow();
+        table = this->current.load(std::memory_order_relaxed);
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t index = hashValue & mask;
+    while (table->buckets[index].hash.load(std::memory_order_relaxed) & FULL_BIT) {
+        index = (index + 1) & mask;
+    }
+    if (table->buckets[index].hash.load(std::memory_order_relaxed) == REMOVED_HASH) {
+        this->numRemoved--;
+    }
+    this->writeBucket(*table, index, hashValue, makeKey(key), value);
+    this->numSize++;
+}
+
+/**
+* grow: Build a new table with every live key and publish it. Readers already in the old table keep
+*   reading it, so it is retired instead of deleted. Key blocks move over to the new table as is.
+*   Removed buckets are dropped, so a table that is mostly removed buckets is rebuilt at the same size.
+*/
+void OptimisticHashTable::grow() {
+    Table* oldTable = this->current.load(std::memory_order_relaxed);
+    size_t newCapacity = std::max(oldTable->capacity, std::bit_ceil((this->numSize + 1) * 4));
+    Table* newTable = new Table(newCapacity);
+
+    //The new table is not published yet, so nothing can read it and no versions are needed
+    size_t mask = newCapacity - 1;
+    for (size_t i = 0; i < oldTable->capacity; i++) {
+        const Bucket& bucket = oldTable->buckets[i];
+        uint64_t bucketHash = bucket.hash.load(std::memory_order_relaxed);
+        if (!(bucketHash & FULL_BIT)) {
+            continue;
+        }
+        size_t index = bucketHash & mask;
+        while (newTable->buckets[index].hash.load(std::memory_order_relaxed) != EMPTY_HASH) {
+            index = (index + 1) & mask;
+        }
+        newTable->buckets[index].hash.store(bucketHash, std::memory_order_relaxed);
+        newTable->buckets[index].key.store(bucket.key.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        newTable->buckets[index].value.store(bucket.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    this->current.store(newTable, std::memory_order_release);
+    this->numRemoved = 0;
+    this->retire(nullptr, oldTable);
+    this->reclaim();
+}
+
+/**
+* retire: Hold on to a key block or table a reader might still be using until reclaim() can prove no
+*   reader is. Writer lock must be held.
+*
+* param :
+*   key: a key block no longer in the table, or nullptr
+*   table: a table no longer published, or nullptr
+*/
+void OptimisticHashTable::retire(const char* key, Table* table) {
+    this->retired.push_back({globalEpoch.load(std::memory_order_relaxed), key, table});
+    if (this->retired.size() >= RECLAIM_BATCH) {
+        this->reclaim();
+    }
+}
+
+/**
+* reclaim: Start a new epoch and free everything retired before the oldest epoch a reader is still in.
+*   A reader that starts after the new epoch began can only see the current table, so it cannot be
+*   holding anything retired earlier. Writer lock must be held.
+*/
+void OptimisticHashTable::reclaim() {
+    if (this->retired.empty()) {
+        return;
+    }
+    globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint64_t oldest = INACTIVE_EPOCH;
+    size_t inUse = slotsInUse.load(std::memory_order_acquire);
+    for (size_t i = 0; i < inUse; i++) {
+        oldest = std::min(oldest, readerSlots[i].epoch.load(std::memory_order_acquire));
+    }
+
+    auto stillNeeded = std::partition(this->retired.begin(), this->retired.end(), [oldest](const Retired& entry) {
+        return entry.epoch >= oldest;
+    });
+    for (auto entry = stillNeeded; entry != this->retired.end(); entry++) {
+        delete[] entry->key;
+        delete entry->table;
+    }
+    this->retired.erase(stillNeeded, this->retired.end());
+}
+
+/**
+* insert: Insert a key-value pair if the key is not already in the table
+*
+* param :
+*   key: the key to input into the table
+*   value: the value associated with the key
+*
+* returns:
+*   bool: true if the key was inserted, false if it was already in the table
+*/
+bool OptimisticHashTable::insert(std::string_view key, size_t value) {
+    uint64_t hashValue = hash(key);
+    std::lock_guard<std::mutex> guard(this->writerLock);
+    if (this->findForWrite(*this->current.load(std::memory_order_relaxed), key, hashValue)) {
+        return false;
+    }
+    this->insertNew(key, hashValue, value);
+    return true;
+}
+
+/**
+* insert_or_assign: Insert a key-value pair, or set the value of the key if it is already in the table
+*
+* param :
+*   key: the key to input into the table
+*   value: the value the key should have
+*
+* returns:
+*   bool: true if the key was inserted, false if an existing value was replaced
+*/
+bool OptimisticHashTable::insert_or_assign(std::string_view key, size_t value) {
+    uint64_t hashValue = hash(key);
+    std::lock_guard<std::mutex> guard(this->writerLock);
+    Table* table = this->current.load(std::memory_order_relaxed);
+    std::optional<size_t> index = this->findForWrite(*table, key, hashValue);
+    if (index) {
+        const char* bucketKey = table->buckets[*index].key.load(std::memory_order_relaxed);
+        this->writeBucket(*table, *index, hashValue, bucketKey, value);
+        return false;
+    }
+    this->insertNew(key, hashValue, value);
+    return true;
+}
+
+/**
+* remove: Remove a key. Its bucket is marked removed so probes keep going past it, and its key block
+*   is retired since a reader may be comparing against it right now.
+*
+* param :
+*   key: the key to remove
+*
+* returns:
+*   bool: true if the key was removed, false if it was not in the table
+*/
+bool OptimisticHashTable::remove(std::string_view key) {
+    uint64_t hashValue = hash(key);
+    std::lock_guard<std::mutex> guard(this->writerLock);
+    Table* table = this->current.load(std::memory_order_relaxed);
+    std::optional<size_t> index = this->findForWrite(*table, key, hashValue);
+    if (!index) {
+        return false;
+    }
+    const char* bucketKey = table->buckets[*index].key.load(std::memory_order_relaxed);
+    this->writeBucket(*table, *index, REMOVED_HASH, nullptr, 0);
+    this->numSize--;
+    this->numRemoved++;
+    this->retire(bucketKey, nullptr);
+    return true;
+}
+
+/**
+* contains: Check if key is in table without taking a lock
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   bool: true if it is in container false if it is not
+*/
+bool OptimisticHashTable::contains(std::string_view key) const {
+    return this->get(key).has_value();
+}
+
+/**
+* get: Check if key is in table and return the value, without taking a lock. A thread that could not
+*   get a reader slot (more than MAX_READER_THREADS readers) reads under the writer lock instead.
+*
+* param :
+*   key: the key to check for in the table
+*
+* returns:
+*   std::optional<size_t>: Value of key if it is in the table or nullopt if key is not in table
+*/
+std::optional<size_t> OptimisticHashTable::get(std::string_view key) const {
+    uint64_t hashValue = hash(key);
+    size_t value = 0;
+    ReadGuard guard;
+    if (!guard.pinned()) {
+        std::lock_guard<std::mutex> lock(this->writerLock);
+        if (readBucket(*this->current.load(std::memory_order_relaxed), key, hashValue, value)) {
+            return value;
+        }
+        return std::nullopt;
+    }
+    if (readBucket(*this->current.load(std::memory_order_acquire), key, hashValue, value)) {
+        return value;
+    }
+    return std::nullopt;
+}
+
+/**
+* size: Returns number of keys in table
+*
+* returns:
+*   size_t: Number of keys
+*/
+size_t OptimisticHashTable::size() const {
+    std::lock_guard<std::mutex> guard(this->writerLock);
+    return this->numSize;
+}
+
+/**
+* capacity: Get the number of buckets in the current table
+*
+* returns:
+*   size_t: Number of total buckets
+*/
+size_t OptimisticHashTable::capacity() const {
+    std::lock_guard<std::mutex> guard(this->writerLock);
+    return this->current.load(std::memory_order_relaxed)->capacity;
+}
+
+/**
+* retiredCount: Get the number of key blocks and tables waiting for readers to drain before they are freed
+*
+* returns:
+*   size_t: Number of retired allocations not yet freed
+*/
+size_t OptimisticHashTable::retiredCount() const {
+    std::lock_guard<std::mutex> guard(this->writerLock);
+    return this->retired.size();
+}
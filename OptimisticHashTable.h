@@ -0,0 +1,96 @@
+#pragma once
+
+#include "HashFunctions.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+/**
+ * OptimisticHashTable.h
+ *
+ * Hash table for read-mostly workloads where get() and contains() never take a lock or write to any
+ * memory other threads read. Buckets are split into groups of GROUP_SIZE, each with a version counter
+ * used as a seqlock: writers make the version odd while they change a group and even again after,
+ * and readers retry a group whose version was odd or changed while they read it.
+ *
+ * Memory that readers might still be looking at (key blocks of removed keys, bucket arrays replaced
+ * by a resize) is freed with epoch based reclamation: each reader thread publishes the epoch it
+ * started in to its own cache line, and the writer only frees memory retired before the oldest
+ * epoch any reader is still in.
+ *
+ * Writers are serialized by a mutex, so the table is safe with any number of writers but is built for
+ * one writer with many readers.
+ */
+class OptimisticHashTable {
+    private:
+        static constexpr uint64_t EMPTY_HASH = 0;
+        static constexpr uint64_t REMOVED_HASH = 1;
+        static constexpr uint64_t FULL_BIT = uint64_t(1) << 63;
+
+        //Every field is atomic so a reader racing with the writer reads stale values instead of tearing
+        struct Bucket {
+            std::atomic<uint64_t> hash{EMPTY_HASH};
+            std::atomic<const char*> key{nullptr};
+            std::atomic<size_t> value{0};
+        };
+
+        struct alignas(64) GroupVersion {
+            std::atomic<uint64_t> version{0};
+        };
+
+        struct Table {
+            size_t capacity;
+            std::unique_ptr<Bucket[]> buckets;
+            std::unique_ptr<GroupVersion[]> versions;
+
+            explicit Table(size_t capacity);
+        };
+
+        struct Retired {
+            uint64_t epoch;
+            const char* key;
+            Table* table;
+        };
+
+        std::atomic<Table*> current;
+        mutable std::mutex writerLock;
+        std::vector<Retired> retired;
+        size_t numSize;
+        size_t numRemoved;
+        WyHash hasher;
+
+        uint64_t hash(std::string_view key) const;
+        static const char* makeKey(std::string_view key);
+        static std::string_view keyView(const char* key);
+        static bool readBucket(const Table& table, std::string_view key, uint64_t hashValue, size_t& value);
+        std::optional<size_t> findForWrite(const Table& table, std::string_view key, uint64_t hashValue) const;
+        void writeBucket(Table& table, size_t index, uint64_t hashValue, const char* key, size_t value);
+        void insertNew(std::string_view key, uint64_t hashValue, size_t value);
+        void grow();
+        void retire(const char* key, Table* table);
+        void reclaim();
+
+    public:
+        static constexpr size_t GROUP_SIZE = 8;
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 64;
+        static constexpr size_t MAX_READER_THREADS = 1024;
+        static constexpr size_t RECLAIM_BATCH = 64;
+
+        explicit OptimisticHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY);
+        ~OptimisticHashTable();
+        OptimisticHashTable(const OptimisticHashTable&) = delete;
+        OptimisticHashTable& operator=(const OptimisticHashTable&) = delete;
+
+        bool insert(std::string_view key, size_t value);
+        bool insert_or_assign(std::string_view key, size_t value);
+        bool remove(std::string_view key);
+        bool contains(std::string_view key) const;
+        std::optional<size_t> get(std::string_view key) const;
+        size_t size() const;
+        size_t capacity() const;
+        size_t retiredCount() const;
+};
@@ -0,0 +1,348 @@
+/**
+ * SwissHashTable.cpp
+ */
+
+#include "SwissHashTable.h"
+
+#include <bit>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+* SwissHashTable constructor: Takes a capacity and rounds it up to a power of two number of full
+*   groups. All control bytes start as empty since start.
+*
+* param :
+*   initCapacity: defaults to 16 but is the base SwissHashTable capacity otherwise
+*/
+SwissHashTable::SwissHashTable(size_t initCapacity) {
+    this->numCapacity = std::bit_ceil(std::max(initCapacity, GROUP_WIDTH));
+    this->numSize = 0;
+    this->numRemoved = 0;
+    this->controlBytes.assign(this->numCapacity, CTRL_ESS);
+    this->slots.resize(this->numCapacity);
+}
+
+/**
+* insert: Inserts a new key-value pair into the table. If the key is already in the table than it
+*   is not inserted. The table is rehashed before the insert would push filled plus removed buckets
+*   past 7/8 of the capacity. The capacity is only doubled if more than 25/32 of the buckets would
+*   still be filled, otherwise the rehash just clears away empty after remove buckets.
+*
+* param :
+*   key: the key to input into the table
+*   value: the value associated with the key
+*/
+bool SwissHashTable::insert(std::string key, size_t value) {
+    size_t hashValue = hash(key);
+    if (this->findSlot(key, hashValue) != std::nullopt) {
+        return false;
+    }
+
+    if ((this->numSize + this->numRemoved + 1) * 8 > this->numCapacity * 7) {
+        //Removed buckets can be cleared by rehashing at the same capacity
+        bool grow = (this->numSize + 1) * 32 > this->numCapacity * 25;
+        this->rehash(grow ? this->numCapacity * 2 : this->numCapacity);
+    }
+
+    size_t index = this->findEmptySlot(hashValue);
+    if (this->controlBytes[index] == CTRL_EAR) {
+        this->numRemoved--;
+    }
+    this->setControl(index, static_cast<int8_t>(hashValue & 0x7F));
+    this->slots[index].key = std::move(key);
+    this->slots[index].value = value;
+    this->numSize++;
+    return true;
+}
+
+/**
+* remove: Check if key is in table if it is mark its control byte empty. If its group still has an
+*   empty since start bucket no probe ever passed through the group, so the bucket can go back to
+*   empty since start instead of empty after remove.
+*
+* param :
+*   key: the key to check for in the table
+*/
+bool SwissHashTable::remove(const std::string& key) {
+    std::optional<size_t> index = this->findSlot(key, hash(key));
+    if (index == std::nullopt) {
+        return false;
+    }
+
+    const int8_t* group = &this->controlBytes[index.value() & ~(GROUP_WIDTH - 1)];
+    if (matchEmpty(group) != 0) {
+        this->setControl(index.value(), CTRL_ESS);
+    }
+    else {
+        this->setControl(index.value(), CTRL_EAR);
+        this->numRemoved++;
+    }
+    this->slots[index.value()].key.clear();
+    this->numSize--;
+    return true;
+}
+
+/**
+* contains: Check if key is in table
+*
+* param :
+*   key: reference to the key to check for in the table
+*
+* returns:
+*   bool: true if it is in container false if it is not
+*/
+bool SwissHashTable::contains(const std::string& key) const {
+    return this->findSlot(key, hash(key)) != std::nullopt;
+}
+
+/**
+* get: Check if key is in table and return the value
+*
+* param :
+*   key: reference to the key to check for in the table
+*
+* returns:
+*   std::optional<size_t>: Value of key if it is in the table or nullopt if key is not in table
+*/
+std::optional<size_t> SwissHashTable::get(const std::string& key) const {
+    if (std::optional<size_t> index = this->findSlot(key, hash(key)); index != std::nullopt) {
+        return this->slots[index.value()].value;
+    }
+    return std::nullopt;
+}
+
+/**
+* operator []: Return the reference to the value of a key for assignment purpouses. A key that is
+*   not in the table is inserted with a value of 0 first.
+*
+* param :
+*   key: reference to the key to check for in the table
+*
+* returns:
+*   size_t&: Reference to value of key
+*/
+size_t& SwissHashTable::operator[](const std::string& key) {
+    size_t hashValue = hash(key);
+    std::optional<size_t> index = this->findSlot(key, hashValue);
+    if (index == std::nullopt) {
+        this->insert(key, 0);
+        index = this->findSlot(key, hashValue);
+    }
+    return this->slots[index.value()].value;
+}
+
+/**
+* keys: Get list of all keys in the table
+*
+* returns:
+*   std::vector<std::string>: List of all non empty buckets keys
+*/
+std::vector<std::string> SwissHashTable::keys() const {
+    std::vector<std::string> curKeyList;
+    curKeyList.reserve(this->numSize);
+    for (size_t i = 0; i < this->numCapacity; i++) {
+        if (this->controlBytes[i] >= 0) {
+            curKeyList.push_back(this->slots[i].key);
+        }
+    }
+    return curKeyList;
+}
+
+/**
+* alpha: get the load factor of the table comprised of size/capacity
+*
+* returns:
+*   double: size/capacity
+*/
+double SwissHashTable::alpha() const {
+    return static_cast<double>(this->numSize) / static_cast<double>(this->numCapacity);
+}
+
+/**
+* capacity: Get capacity of table (total number of buckets)
+*
+* returns:
+*   size_t: Number of total buckets
+*/
+size_t SwissHashTable::capacity() const {
+    return this->numCapacity;
+}
+
+/**
+* size: Returns number of buckets that are not empty
+*
+* returns:
+*   size_t: Number of keys in the table
+*/
+size_t SwissHashTable::size() const {
+    return this->numSize;
+}
+
+/**
+* hash: Use the table's seeded WyHash to convert string into hashed value. The low 7 bits become the
+*   key's tag and the rest pick its first group.
+*
+* returns:
+*   size_t: Hashed value of key
+*/
+size_t SwissHashTable::hash(const std::string& key) const {
+    return this->hasher(key);
+}
+
+/**
+* matchTag: find the buckets of a group whose control byte equals a tag
+*
+* param :
+*   group: pointer to the first of GROUP_WIDTH control bytes
+*   tag: the control byte to look for
+*
+* returns:
+*   uint32_t: Bit i is set when bucket i of the group matches
+*/
+uint32_t SwissHashTable::matchTag(const int8_t* group, int8_t tag) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; i++) {
+        mask |= static_cast<uint32_t>(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+* matchEmpty: find the buckets of a group that are empty since start
+*
+* param :
+*   group: pointer to the first of GROUP_WIDTH control bytes
+*
+* returns:
+*   uint32_t: Bit i is set when bucket i of the group is empty since start
+*/
+uint32_t SwissHashTable::matchEmpty(const int8_t* group) {
+    return matchTag(group, CTRL_ESS);
+}
+
+/**
+* matchEmptyOrRemoved: find the buckets of a group that can take a new key. Both empty control
+*   bytes are negative and tags never are, so this is just the sign bit of each byte.
+*
+* param :
+*   group: pointer to the first of GROUP_WIDTH control bytes
+*
+* returns:
+*   uint32_t: Bit i is set when bucket i of the group is empty
+*/
+uint32_t SwissHashTable::matchEmptyOrRemoved(const int8_t* group) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; i++) {
+        mask |= static_cast<uint32_t>(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+* findSlot: probe the table a group at a time for a key. Groups are visited in triangular order
+*   (1, 2, 3... groups apart), which reaches every group because the group count is a power of two.
+*
+* param :
+*   key: reference to the key to look for
+*   hashValue: the hashed value of the key
+*
+* returns:
+*   std::optional<size_t>: Index of the key's bucket or nullopt if it is not in the table
+*/
+std::optional<size_t> SwissHashTable::findSlot(const std::string& key, size_t hashValue) const {
+    size_t groupMask = this->numCapacity / GROUP_WIDTH - 1;
+    size_t group = (hashValue >> 7) & groupMask;
+    int8_t tag = static_cast<int8_t>(hashValue & 0x7F);
+
+    for (size_t i = 0; i <= groupMask; i++) {
+        const int8_t* ctrl = &this->controlBytes[group * GROUP_WIDTH];
+        //Only buckets with a matching tag have their key compared
+        for (uint32_t match = matchTag(ctrl, tag); match != 0; match &= match - 1) {
+            size_t index = group * GROUP_WIDTH + std::countr_zero(match);
+            if (this->slots[index].key == key) {
+                return index;
+            }
+        }
+
+        //A group with an empty since start bucket ends every probe that reaches it
+        if (matchEmpty(ctrl) != 0) {
+            return std::nullopt;
+        }
+        group = (group + i + 1) & groupMask;
+    }
+    return std::nullopt;
+}
+
+/**
+* findEmptySlot: probe for the first bucket that can take a new key
+*
+* param :
+*   hashValue: the hashed value of the key being inserted
+*
+* returns:
+*   size_t: Index of an empty bucket
+*/
+size_t SwissHashTable::findEmptySlot(size_t hashValue) const {
+    size_t groupMask = this->numCapacity / GROUP_WIDTH - 1;
+    size_t group = (hashValue >> 7) & groupMask;
+
+    for (size_t i = 0; ; i++) {
+        uint32_t match = matchEmptyOrRemoved(&this->controlBytes[group * GROUP_WIDTH]);
+        if (match != 0) {
+            return group * GROUP_WIDTH + std::countr_zero(match);
+        }
+        group = (group + i + 1) & groupMask;
+    }
+}
+
+/**
+* setControl: set the control byte of a bucket
+*
+* param :
+*   index: the bucket to set
+*   control: tag or empty marker for the bucket
+*/
+void SwissHashTable::setControl(size_t index, int8_t control) {
+    this->controlBytes[index] = control;
+}
+
+/**
+* rehash: Move every key-value pair into new arrays of the given capacity, dropping all empty after
+*   remove buckets
+*
+* param :
+*   newCapacity: the number of buckets the new table should have, a power of two
+*/
+void SwissHashTable::rehash(size_t newCapacity) {
+    std::vector<int8_t> oldControlBytes = std::move(this->controlBytes);
+    std::vector<Slot> oldSlots = std::move(this->slots);
+
+    this->numCapacity = newCapacity;
+    this->numRemoved = 0;
+    this->controlBytes.assign(newCapacity, CTRL_ESS);
+    this->slots.clear();
+    this->slots.resize(newCapacity);
+
+    for (size_t i = 0; i < oldControlBytes.size(); i++) {
+        if (oldControlBytes[i] >= 0) {
+            size_t hashValue = hash(oldSlots[i].key);
+            size_t index = this->findEmptySlot(hashValue);
+            this->setControl(index, oldControlBytes[i]);
+            this->slots[index] = std::move(oldSlots[i]);
+        }
+    }
+}
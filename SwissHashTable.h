@@ -0,0 +1,78 @@
+#pragma once
+
+#include "HashFunctions.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include <ostream>
+/**
+ * SwissHashTable.h
+ *
+ * Alternative layout of HashTable where bucket state lives in a dense array of control bytes
+ * instead of inside each bucket. A control byte is either empty since start, empty after remove,
+ * or the low 7 bits of the key's hash (its tag). Buckets are probed 16 at a time: one compare of
+ * a group of control bytes finds every bucket whose tag matches, and only those buckets' keys
+ * are read.
+ */
+class SwissHashTable {
+    private:
+        static constexpr int8_t CTRL_ESS = -128;
+        static constexpr int8_t CTRL_EAR = -2;
+
+        struct Slot {
+            std::string key;
+            size_t value;
+        };
+
+        std::vector<int8_t> controlBytes;
+        std::vector<Slot> slots;
+        size_t numCapacity;
+        size_t numSize;
+        size_t numRemoved;
+        WyHash hasher;
+
+        static uint32_t matchTag(const int8_t* group, int8_t tag);
+        static uint32_t matchEmpty(const int8_t* group);
+        static uint32_t matchEmptyOrRemoved(const int8_t* group);
+        std::optional<size_t> findSlot(const std::string& key, size_t hashValue) const;
+        size_t findEmptySlot(size_t hashValue) const;
+        void setControl(size_t index, int8_t control);
+        void rehash(size_t newCapacity);
+
+    public:
+        static constexpr size_t GROUP_WIDTH = 16;
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 16;
+
+        explicit SwissHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY);
+        bool insert(std::string key, size_t value);
+        bool remove(const std::string& key);
+        bool contains(const std::string& key) const;
+        std::optional<size_t> get(const std::string& key) const;
+        size_t capacity() const;
+        size_t& operator[](const std::string& key);
+        std::vector<std::string> keys() const;
+        double alpha() const;
+        size_t size() const;
+        size_t hash(const std::string& key) const;
+
+    /**
+     *
+     * << operator: this operator prints to stream the filled buckets of the hashTable
+     *      Format of each bucket is: Bucket (index): <key, value>
+     *
+     *      paramaters:
+     *          os: refrence to output stream used
+     *          hashTable: reference to the hashTable that shall be used
+     *
+    */
+    friend std::ostream& operator<<(std::ostream& os, const SwissHashTable& hashTable) {
+        for (size_t i = 0; i < hashTable.numCapacity; i++) {
+            if (hashTable.controlBytes[i] >= 0) {
+                os << "Bucket " << i << ": <" << hashTable.slots[i].key << ", " << hashTable.slots[i].value << ">" << std::endl;
+            }
+        }
+        return os;
+    }
+};